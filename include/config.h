@@ -25,6 +25,8 @@ typedef struct {
     int min_members_per_gang;
     int max_members_per_gang;
     int gang_ranks;
+    int gang_hosts;        // Processes (threads with --mode=threads) running the gangs, 0 = one per core
+    int member_tick_ms;    // Lock-step member tick length, 0 = as fast as possible
     
     // Crime planning
     int preparation_time_min;
@@ -32,13 +34,22 @@ typedef struct {
     int min_preparation_level;
     int max_preparation_level;
     int false_info_probability;
+    int tip_fanout;               // Members a preparing member tips per tick, 0 = all of them
     
     // Secret agents
     int agent_infiltration_success_rate;
     int agent_suspicion_threshold;
     int police_action_threshold;
+    int police_processes;  // Police processes, each consuming one report queue partition
+    int police_threads;    // Police shard threads per police process, 0 = one per core
     int truth_gain;        // Knowledge gain when receiving truthful information
     int false_penalty;     // Knowledge penalty when receiving false information
+    int outbox_flush_ms;   // How often a gang host sends its agents' reports in a batch
+    
+    // Gang investigations (see investigation.h)
+    char investigation_scoring[256];    // Weighted scoring features, name:weight,...
+    int investigation_threshold;        // Score a member must exceed to be a suspect
+    int investigation_top_k;            // Suspects interrogated per investigation
     
     // Mission outcomes
     int mission_success_rate_base;
@@ -51,8 +62,21 @@ typedef struct {
     int max_successful_plans;
     int max_executed_agents;
     
+    // CPU and NUMA placement (see placement.h)
+    char placement[256];            // none, compact, spread or a cpu list such as 0-3,8
+    
     // Visualization
     int visualization_refresh_rate;
+    char terminal_log_file[256];    // Log file used while the terminal dashboard owns the terminal
+    
+    // Metrics export (crime_sim --metrics)
+    int metrics_interval_ms;        // How often the registry is exported
+    char metrics_file[256];         // Prometheus text file written every interval
+    char metrics_socket[108];       // Unix socket the latest export is served on
+    
+    // Binary state stream (crime_sim --stream)
+    int stream_interval_ms;         // How often shared memory is sampled for deltas
+    char stream_socket[108];        // Unix socket the stream is served on
 } SimulationConfig;
 
 // Function prototypes
@@ -3,23 +3,36 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "config.h"
+#include "mailbox.h"
+#include "investigation.h"
 
-// Gang member structure
+// Gang member structure. preparation_level, knowledge and knowledge_rate are
+// written only by the member's own thread (or by gang-wide operations, which
+// exclude member ticks) and can be read at any time without a lock.
 typedef struct {
     int id;
     int rank;
-    int preparation_level;
-    int knowledge;    // Knowledge about current mission
+    atomic_int preparation_level;
+    atomic_int knowledge;    // Knowledge about current mission
     int suspicion;    // How suspicious the member appears
     bool is_secret_agent;
     bool alive;       // Whether the member is alive
     bool in_prison;   // Whether the member is in prison
-    int knowledge_rate;
+    atomic_int knowledge_rate;
+    TipMailbox inbox[2];     // Tips for tick t are posted to inbox[t % 2] during tick t - 1
     pthread_t thread;
     void* gang_ptr;  // Pointer back to the gang
 } GangMember;
 
+// What members see of each other during a tick: the state at the end of the previous one
+typedef struct {
+    int rank;
+    bool alive;
+    bool in_prison;
+} MemberView;
+
 // Gang structure
 typedef struct {
     int id;
@@ -29,6 +42,7 @@ typedef struct {
     
     // Gang state
     CrimeType current_target;
+    unsigned int mission;  // Bumped by every plan_new_mission, reports coalesce per mission
     int preparation_time;
     int required_preparation_level;
     bool is_active;
@@ -37,6 +51,7 @@ typedef struct {
     int false_info_probability;
     int truth_gain;        // Knowledge gain when receiving truthful information
     int false_penalty;     // Knowledge penalty when receiving false information
+    int tip_fanout;        // Members a preparing member tips each tick, 0 = all of them
     
     // Statistics
     int successful_missions;
@@ -46,6 +61,20 @@ typedef struct {
     // Synchronization
     pthread_mutex_t gang_mutex;
     pthread_cond_t gang_cond;
+    pthread_rwlock_t member_lock;   // Shared by member ticks, exclusive for gang-wide operations
+    
+    // Lock-step member ticks driven by gang_leader_routine
+    pthread_t leader_thread;
+    pthread_barrier_t tick_start;   // Releases the members into a tick
+    pthread_barrier_t tick_end;     // The leader waits here for every member to finish
+    bool tick_running;              // False on the release that tells members to exit
+    unsigned long tick;
+    int tick_interval_ms;
+    MemberView* member_views[2];    // Double buffer of member state for peer reads
+    int front_view;                 // Buffer the members read during the current tick
+    
+    // Reused by every investigate_for_agents of the gang
+    InvestigationScratch investigation;
     
     // IPC
     int report_queue_id;
@@ -0,0 +1,55 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Per-gang metric history with constant memory.
+//
+// Every sample is folded into the current bucket of each resolution level,
+// so a level is a ring of min/max/sum/count buckets covering a fixed span of
+// time: the last minute in 1 s buckets, the last half hour in 30 s buckets and
+// the last ten hours in 10 min buckets. Buckets of intervals without samples
+// stay empty. Viewers read whole rings and never see individual samples.
+
+// Recorded metrics
+typedef enum {
+    HISTORY_PREPARATION,       // Average member preparation, percent of the required level
+    HISTORY_AGENT_KNOWLEDGE,   // Average knowledge of the live agents, 0-100
+    HISTORY_REPORTS,           // Reports sent by agents since the previous sample
+    HISTORY_ARRESTED,          // 100 while the gang is in prison, 0 otherwise
+    HISTORY_METRICS
+} HistoryMetric;
+
+#define HISTORY_LEVELS 3
+#define HISTORY_BUCKETS 60
+
+// Seconds covered by one bucket of each level
+#define HISTORY_LEVEL_SECONDS { 1, 30, 600 }
+
+// One bucket - count is 0 for an interval without samples
+typedef struct {
+    short min;
+    short max;
+    unsigned short count;
+    int sum;
+} HistoryBucket;
+
+// History of one gang, written only by its gang process.
+// `generation` is odd while a sample is being recorded.
+typedef struct {
+    atomic_uint generation;
+    long long newest[HISTORY_LEVELS];     // Bucket number (time / bucket seconds) of each level's newest bucket
+    HistoryBucket buckets[HISTORY_LEVELS][HISTORY_METRICS][HISTORY_BUCKETS];
+} GangHistory;
+
+// Function prototypes
+int history_level_seconds(int level);
+void history_span_label(int level, char* label, size_t size);
+void history_record(GangHistory* history, const int values[HISTORY_METRICS], long long now_s);
+bool history_read(const GangHistory* history, int level, long long now_s,
+                  HistoryBucket out[HISTORY_METRICS][HISTORY_BUCKETS]);
+unsigned int history_generation(const GangHistory* history);
+
+#endif /* HISTORY_H */
@@ -0,0 +1,23 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stdbool.h>
+
+// Viewer-side ingestion of gang state.
+//
+// One component feeds every renderer: each tick it reads the dashboard record
+// and arrest status of all gangs from shared memory in a single pass, updates
+// viz_context.gang_states, and publishes one snapshot if anything visible
+// changed. Reading the records costs no system calls, so a tick stays cheap
+// however many gangs there are. Used by crime_sim (GL and terminal) and
+// crime_view alike.
+
+// Time between ingestion ticks
+#define INGEST_INTERVAL_MS 200
+
+// Function prototypes
+bool ingest_tick();
+bool ingest_start();
+void ingest_stop();
+
+#endif /* INGEST_H */
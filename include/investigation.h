@@ -0,0 +1,54 @@
+#ifndef INVESTIGATION_H
+#define INVESTIGATION_H
+
+#include <stdbool.h>
+#include "utils.h"
+
+// Internal investigation engine used by investigate_for_agents.
+//
+// Members are copied into columns carved out of an arena the gang keeps between
+// investigations, so an investigation allocates nothing once the arena has
+// grown to the gang's size. Every member's suspicion score is the weighted sum
+// of the scoring features below; the top k members scoring above the threshold
+// are picked with a partial selection in O(n) instead of sorting everyone.
+//
+// Features and weights come from INVESTIGATION_SCORING, a comma separated list
+// of name:weight pairs (features not listed count 0):
+//   low_preparation  1 when preparation is below half the required level
+//   low_rank         ranks below the top rank
+//   knows_too_much   1 when a member of rank 0 or 1 has knowledge rate above 80
+//   knowledge        the knowledge rate itself
+#define DEFAULT_INVESTIGATION_SCORING "low_preparation:20,low_rank:5,knows_too_much:25"
+
+// What an interrogation decided for a suspect
+#define VERDICT_NONE 0
+#define VERDICT_EXECUTE 1
+#define VERDICT_PENALIZE 2
+
+// Per-gang scratch area, reused by every investigation of the gang
+typedef struct {
+    Arena arena;                // Holds the columns of the current investigation
+    int count;                  // Members copied in for this investigation
+    int num_ranks;
+    int required_preparation;
+
+    // Member columns, filled by the caller
+    int* preparation;
+    int* knowledge_rate;
+    int* rank;
+    unsigned char* is_agent;
+
+    // Filled by investigation_select
+    int* score;                 // Per member
+    int* order;                 // Selected member ids, most suspicious first
+    unsigned char* verdict;     // Per selected suspect, VERDICT_*
+} InvestigationScratch;
+
+// Function prototypes
+bool investigation_configure(const char* scoring);
+bool investigation_init(InvestigationScratch* scratch, int members);
+bool investigation_begin(InvestigationScratch* scratch, int members);
+void investigation_free(InvestigationScratch* scratch);
+int investigation_select(InvestigationScratch* scratch, int threshold, int top_k, int* num_suspects);
+
+#endif /* INVESTIGATION_H */
@@ -6,47 +6,154 @@
 #include <sys/msg.h>
 #include <sys/shm.h>
 #include <sys/sem.h>
+#include <stdatomic.h>
 #include "police.h"
+#include "history.h"
 
 // Define keys for IPC resources
 #define REPORT_QUEUE_KEY 0x1234
 #define SHARED_MEMORY_KEY 0x5678
 #define SEMAPHORE_KEY 0x9ABC
+#define METRICS_SHM_KEY 0xDEF0
+
+// Every run id gets its own set of keys, so several simulations (and the
+// viewers attached to them) can coexist on one machine
+#define RUN_KEY_STRIDE 0x10000
+#define MAX_RUN_ID 9999
+#define RUN_KEY(base) ((key_t)((base) + ipc_run_id * RUN_KEY_STRIDE))
+
+extern int ipc_run_id;
+
+// How the gangs and the police are hosted (crime_sim --mode)
+typedef enum {
+    IPC_MODE_PROCESSES,     // One forked process per gang plus a police process
+    IPC_MODE_THREADS        // One thread per gang and for the police in a single process
+} IpcMode;
+
+// In IPC_MODE_THREADS the report queue and the state semaphore are in-memory
+// channels of this process; the shared memory segment stays so viewers can attach
+extern IpcMode ipc_mode;
+
+// Largest number of gangs that has a slot in shared memory
+#define MAX_SHARED_GANGS 100
+
+// Largest number of members per gang published in the member tables
+#define MAX_SHARED_MEMBERS 64
+
+// GangMemberRecord flags
+#define MEMBER_FLAG_AGENT 0x01
+#define MEMBER_FLAG_ALIVE 0x02
+#define MEMBER_FLAG_IN_PRISON 0x04
+
+// Priority lanes of the report queue, drained most urgent first. A report's
+// lane is its message type, so a receive with a negative type takes the lowest.
+typedef enum {
+    REPORT_LANE_URGENT = 1,     // High-risk crime with suspicion at the police action threshold
+    REPORT_LANE_PRIORITY,       // High-risk crime, or suspicion at the threshold
+    REPORT_LANE_ROUTINE
+} ReportLane;
+
+#define NUM_REPORT_LANES 3
+
+// Suspicion that makes a report urgent (POLICE_ACTION_THRESHOLD)
+extern int report_lane_threshold;
+
+// The report queue is split into partitions, one per police process
+// (POLICE_PROCESSES). Each partition is a queue of its own carrying the reports
+// about a contiguous range of gang ids, so police processes never compete for
+// a report.
+#define MAX_REPORT_PARTITIONS 16
+
+// Partitions and the gangs they are split over, set by crime_sim before forking
+extern int report_partitions;
+extern int report_partition_gangs;
 
 // Message queue structure for intelligence reports
 typedef struct {
-    long mtype;  // Message type
+    long mtype;  // Message type - the report's lane
     IntelligenceReport report;
+    long long sent_us;  // monotonic_time_us() at send, for the lane latency
 } ReportMessage;
 
-// Shared memory structure for simulation state
+// Dashboard view of one gang, published by its gang process for viewers.
+// Written under a sequence lock: `sequence` is odd while an update is in progress.
+typedef struct {
+    atomic_uint sequence;
+    int preparation_level;
+    CrimeType current_target;
+    int num_members;
+    int num_agents;
+    bool is_active;
+} GangVisRecord;
+
+// Compact view of one gang member for the dashboard's expanded gang rows
 typedef struct {
+    unsigned short id;
+    unsigned char rank;
+    unsigned char preparation;   // Percent of the gang's required preparation level
+    unsigned char knowledge;     // 0-100
+    unsigned char flags;         // MEMBER_FLAG_*
+} GangMemberRecord;
+
+// Member table of one gang, rewritten as a whole by its gang process.
+// `generation` is odd while a rewrite is in progress.
+typedef struct {
+    atomic_uint generation;
+    int num_members;
+    GangMemberRecord members[MAX_SHARED_MEMBERS];
+} GangMemberTable;
+
+// Shared memory structure for simulation state
+typedef struct SharedState {
     int num_gangs;
     int total_successful_missions;
     int total_thwarted_missions;
     int total_executed_agents;
     bool simulation_running;
     
+    // Bumped by every process that publishes a visible change, so viewers
+    // can skip redrawing when nothing happened
+    atomic_uint state_version;
+    
     // Gang arrest status - used for police to communicate with gangs
     struct {
         bool is_arrested;
         int prison_time;
         bool arrest_notification_seen;
-    } gang_status[100]; // Assuming max 100 gangs
+    } gang_status[MAX_SHARED_GANGS];
+    
+    // Per-gang dashboard records - lets viewers attach read-only
+    GangVisRecord gang_vis[MAX_SHARED_GANGS];
+    
+    // Per-gang member tables - read only for gangs a viewer has expanded
+    GangMemberTable member_tables[MAX_SHARED_GANGS];
+    
+    // Per-gang downsampled metric history for sparklines
+    GangHistory gang_history[MAX_SHARED_GANGS];
 } SharedState;
 
 // Function prototypes
-int create_report_queue();
+int create_report_queue(int partition);
 void destroy_report_queue(int queue_id);
+int report_partition(int gang_id);
+ReportLane report_lane(IntelligenceReport report);
 int send_report(int queue_id, IntelligenceReport report);
-int receive_report(int queue_id, IntelligenceReport* report);
+int receive_report(int queue_id, IntelligenceReport* report, long long* sent_us);
 
 int create_shared_memory();
 void destroy_shared_memory(int shm_id);
 SharedState* attach_shared_memory(int shm_id);
+SharedState* attach_shared_memory_readonly(int shm_id);
 void detach_shared_memory(SharedState* shm_ptr);
+void publish_state_change(SharedState* shm_ptr);
+void publish_gang_record(SharedState* shm_ptr, int gang_id, const GangVisRecord* record);
+bool read_gang_record(const SharedState* shm_ptr, int gang_id, GangVisRecord* record);
+void publish_member_table(SharedState* shm_ptr, int gang_id, const GangMemberRecord* members, int num_members);
+unsigned int member_table_generation(const SharedState* shm_ptr, int gang_id);
+unsigned int read_member_table(const SharedState* shm_ptr, int gang_id, GangMemberRecord* members, int* num_members);
 
 int create_semaphore_set();
+int open_semaphore_set();
 void destroy_semaphore_set(int sem_id);
 void semaphore_wait(int sem_id, int sem_num);
 void semaphore_signal(int sem_id, int sem_num);
@@ -0,0 +1,32 @@
+#ifndef LOCK_PROFILE_H
+#define LOCK_PROFILE_H
+
+#include <pthread.h>
+
+// Instrumented mutex wrappers for finding lock contention.
+//
+// Build with `make profile-locks` (defines LOCK_PROFILE) to record, per lock,
+// acquisition counts, wait-time and hold-time histograms and the most
+// contended call sites. Each process prints a summary when it exits.
+// Without LOCK_PROFILE the wrappers are plain pthread calls.
+
+#ifdef LOCK_PROFILE
+
+#define sim_mutex_lock(m)      profiled_mutex_lock((m), #m, __FILE__, __LINE__)
+#define sim_mutex_unlock(m)    profiled_mutex_unlock((m))
+#define sim_cond_wait(c, m)    profiled_cond_wait((c), (m), #m, __FILE__, __LINE__)
+
+int profiled_mutex_lock(pthread_mutex_t* mutex, const char* name, const char* file, int line);
+int profiled_mutex_unlock(pthread_mutex_t* mutex);
+int profiled_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, const char* name, const char* file, int line);
+void lock_profile_report();
+
+#else
+
+#define sim_mutex_lock(m)      pthread_mutex_lock(m)
+#define sim_mutex_unlock(m)    pthread_mutex_unlock(m)
+#define sim_cond_wait(c, m)    pthread_cond_wait((c), (m))
+
+#endif /* LOCK_PROFILE */
+
+#endif /* LOCK_PROFILE_H */
@@ -0,0 +1,41 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// A piece of information one gang member passes to another. Whether it is
+// true was decided by the sender (deliver_truth) when it was posted.
+typedef struct {
+    unsigned short sender;
+    unsigned char sender_rank;
+    bool truthful;
+} Tip;
+
+// Bounded lock-free mailbox: any number of senders post, only the owning member
+// takes. Each cell's sequence number says whether it is free for the sender at
+// that position or holds a tip for the owner, so neither side ever blocks; a
+// post to a full mailbox fails and the tip is dropped.
+typedef struct {
+    atomic_uint sequence;
+    Tip tip;
+} TipCell;
+
+typedef struct {
+    TipCell* cells;
+    unsigned int mask;          // Capacity - 1, capacity is a power of two
+    atomic_uint tail;           // Next position a sender claims
+    unsigned int head;          // Next position the owner takes (owner only)
+    atomic_uint dropped;        // Tips lost to a full mailbox
+} TipMailbox;
+
+// Largest mailbox, whatever the gang size
+#define MAILBOX_MAX_CAPACITY 256
+
+// Function prototypes
+bool mailbox_init(TipMailbox* mailbox, unsigned int capacity);
+void mailbox_destroy(TipMailbox* mailbox);
+bool mailbox_post(TipMailbox* mailbox, Tip tip);
+bool mailbox_take(TipMailbox* mailbox, Tip* tip);
+
+#endif /* MAILBOX_H */
@@ -0,0 +1,109 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Upper bound on gangs tracked per-gang in the registry (matches SharedState)
+#define METRICS_MAX_GANGS 100
+
+// Report queue priority lanes (matches NUM_REPORT_LANES)
+#define METRICS_REPORT_LANES 3
+
+// Police pipeline stages fed by a queue (matches NUM_POLICE_STAGES)
+#define METRICS_POLICE_STAGES 3
+
+// Number of histogram buckets, including the final +Inf bucket
+#define METRICS_HISTOGRAM_BUCKETS 19
+
+// Monotonic counter - only ever increases
+typedef struct {
+    atomic_ulong value;
+} MetricCounter;
+
+// Gauge - a value that can go up and down
+typedef struct {
+    atomic_long value;
+} MetricGauge;
+
+// Histogram of durations in microseconds (non-cumulative bucket counts)
+typedef struct {
+    atomic_ulong buckets[METRICS_HISTOGRAM_BUCKETS];
+    atomic_ulong count;
+    atomic_ulong sum_us;
+} MetricHistogram;
+
+// Metrics registry living in shared memory - every process writes into it
+// with relaxed atomics, only the exporter process ever reads it
+typedef struct {
+    // Intelligence flow
+    MetricCounter reports_sent;
+    MetricCounter reports_failed;
+    MetricCounter reports_coalesced;    // Merged into a newer report in an agent outbox
+    MetricCounter reports_received;
+    MetricGauge report_queue_depth;
+    MetricHistogram report_latency[METRICS_REPORT_LANES];   // Send to receive, per lane
+    MetricHistogram report_decision_latency[METRICS_REPORT_LANES];  // Send to police decision, per lane
+
+    // Police activity
+    MetricCounter decisions_act;
+    MetricCounter decisions_hold;
+    MetricCounter arrests;
+    MetricGauge police_backlog;
+    MetricGauge police_stage_depth[METRICS_POLICE_STAGES];          // Tasks queued for the stage
+    MetricHistogram police_stage_latency[METRICS_POLICE_STAGES];    // Queued to handled, per stage
+
+    // Gang activity
+    MetricCounter missions_succeeded;
+    MetricCounter missions_failed;
+    MetricCounter agents_executed;
+    MetricGauge num_gangs;
+    MetricHistogram gang_tick[METRICS_MAX_GANGS];
+    
+    // Dashboard ingestion (coordinator)
+    MetricHistogram ingest_tick;
+    MetricCounter snapshots_published;
+    
+    // Scratch memory (arenas and object pools in utils)
+    MetricCounter scratch_allocations_avoided;  // Served without touching the heap
+    MetricCounter scratch_heap_allocations;     // Arena blocks, spills and pool slabs
+} MetricsRegistry;
+
+// Registry of the current process (NULL when metrics are not available)
+extern MetricsRegistry* metrics_registry;
+
+// Hot-path helpers - a single relaxed atomic operation each, no-ops without a registry
+#define METRICS_INC(field) \
+    do { \
+        if (metrics_registry != NULL) \
+            atomic_fetch_add_explicit(&metrics_registry->field.value, 1, memory_order_relaxed); \
+    } while (0)
+
+#define METRICS_SET(field, v) \
+    do { \
+        if (metrics_registry != NULL) \
+            atomic_store_explicit(&metrics_registry->field.value, (v), memory_order_relaxed); \
+    } while (0)
+
+#define METRICS_ADD(field, v) \
+    do { \
+        if (metrics_registry != NULL) \
+            atomic_fetch_add_explicit(&metrics_registry->field.value, (v), memory_order_relaxed); \
+    } while (0)
+
+// Function prototypes
+int create_metrics_registry();
+void destroy_metrics_registry(int shm_id);
+MetricsRegistry* attach_metrics_registry(int shm_id);
+void detach_metrics_registry(MetricsRegistry* registry);
+
+void metrics_observe_us(MetricHistogram* histogram, long long duration_us);
+void metrics_observe_gang_tick(int gang_id, long long duration_us);
+void metrics_observe_report_latency(int lane, long long duration_us);
+void metrics_observe_report_decision(int lane, long long duration_us);
+void metrics_observe_police_stage(int stage, long long duration_us);
+
+void run_metrics_exporter(SimulationConfig config, const int* report_queue_ids);
+
+#endif /* METRICS_H */
@@ -0,0 +1,29 @@
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <stdbool.h>
+#include "police.h"
+
+// Agent report outbox of a gang host process (one per process, shared by all
+// its gangs). Agents post reports without ever blocking; a sender thread drains
+// them every OUTBOX_FLUSH_MS, coalesces the reports of one agent about one
+// mission into the latest of them, and sends each report to the report queue
+// partition of its gang. Reports a partition has no room for stay pending for
+// the next flush.
+
+// Reports the outbox holds before posts fail
+#define OUTBOX_CAPACITY 1024
+
+// Distinct agent/mission reports a flush can hold back for retrying
+#define OUTBOX_MAX_PENDING 256
+
+// Gangs the outbox counts sent reports for (matches MAX_SHARED_GANGS)
+#define OUTBOX_MAX_GANGS 100
+
+// Function prototypes
+bool outbox_start(const int* report_queue_ids, int flush_ms);
+bool outbox_post(IntelligenceReport report, unsigned int mission);
+void outbox_stop();
+unsigned int outbox_reports_sent(int gang_id);
+
+#endif /* OUTBOX_H */
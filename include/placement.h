@@ -0,0 +1,39 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// CPU and NUMA placement of the simulation (PLACEMENT in the config file).
+//
+// The policy orders the CPUs the simulation may use into a list:
+//   none     - no pinning, the scheduler decides (default)
+//   compact  - fill one NUMA node before moving on to the next
+//   spread   - take CPUs from the NUMA nodes in turn
+//   a cpu list such as "0-3,8,10" - exactly these CPUs, in this order
+// The first CPU of the list belongs to the coordinator's visualization and
+// ingestion threads and to viewers. The police get a range of CPUs after it
+// (placement_reserve_police) that their processes and worker threads (shards)
+// share out, each process taking a block of the range for its shards. The CPUs
+// after the police range are shared out among the gang hosts, whose member
+// threads inherit the host's CPU. Lists shorter than three CPUs are reused
+// from the start.
+
+typedef enum {
+    PLACEMENT_ROLE_VIEWER,      // Coordinator threads, side processes and crime_view
+    PLACEMENT_ROLE_POLICE,
+    PLACEMENT_ROLE_POLICE_WORKER,
+    PLACEMENT_ROLE_GANG_HOST
+} PlacementRole;
+
+// Function prototypes
+bool placement_init(const char* policy);
+bool placement_enabled();
+void placement_reserve_police(int processes, int threads);
+int placement_cpu(PlacementRole role, int index);
+int placement_role_cpus(PlacementRole role);
+int placement_node_of_cpu(int cpu);
+void placement_pin_thread(PlacementRole role, int index);
+void placement_bind_memory(void* addr, size_t length, PlacementRole role, int count);
+
+#endif /* PLACEMENT_H */
@@ -2,10 +2,13 @@
 #define POLICE_H
 
 #include <pthread.h>
+#include <semaphore.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <sys/types.h>
 #include "config.h"
 #include "gang.h"
+#include "utils.h"
 
 // Information structure passed from agents to police
 typedef struct {
@@ -16,33 +19,162 @@ typedef struct {
     bool is_reliable;
 } IntelligenceReport;
 
-// Police structure
+// A report the police hold, recycled through the police report pool
+typedef struct StoredReport {
+    IntelligenceReport report;
+    struct StoredReport* next;
+} StoredReport;
+
+// Stored reports are added to the pool this many at a time
+#define REPORT_POOL_SLAB 128
+
+// Stages of the police pipeline after ingestion. Each stage runs on its own
+// thread(s) and is fed by a bounded lock-free queue, so a slow stage only
+// holds up the stages before it once its queue is full:
+//   ingestion    receives reports and routes each to the shard owning its gang
+//   aggregation  a shard stores the report and gathers the evidence on the gang
+//   decision     weighs the evidence and orders arrests
+//   arrest       applies arrests to the shared state
+typedef enum {
+    POLICE_STAGE_AGGREGATION,
+    POLICE_STAGE_DECISION,
+    POLICE_STAGE_ARREST
+} PoliceStage;
+
+#define NUM_POLICE_STAGES 3
+
+// Priority lanes every stage keeps its reports and tasks in, numbered like
+// the report lanes (1 = urgent, 2 = priority, 3 = routine). A stage always
+// takes from the most urgent lane that has work, so urgent reports overtake
+// routine ones all the way to the arrest.
+#define POLICE_LANES 3
+#define POLICE_LANE_ROUTINE 3
+
+// Reports each lane of a shard's inbox holds; a full lane holds up ingestion
+#define POLICE_SHARD_INBOX 1024
+
+// Tasks each lane of the decision and arrest queues holds
+#define POLICE_QUEUE_CAPACITY 256
+
+// How often a shard sweeps its reports for the gang reported most (seconds)
+#define POLICE_SWEEP_INTERVAL 2
+
+// Gang ids a shard can be told to clear the reports of (matches MAX_SHARED_GANGS)
+#define POLICE_MAX_GANGS 100
+
+// A report in a shard's inbox
+typedef struct {
+    IntelligenceReport report;
+    int lane;                   // Report lane it arrived on
+    long long sent_us;          // When the agent sent it
+    long long queued_us;        // When ingestion routed it
+} RoutedReport;
+
+// Evidence on a gang gathered by the aggregation stage, passed on to the
+// decision stage and, as an arrest order, to the arrest stage
+typedef struct {
+    int gang_id;
+    int shard;                  // Shard holding the gang's reports
+    int num_reports;
+    int total_suspicion;
+    int num_reliable_reports;
+    CrimeType most_likely_crime;
+    bool from_sweep;            // Gathered by a sweep, which clears the reports it acted on
+    int lane;                   // Lane of the report it was gathered for (sweeps: routine)
+    long long sent_us;          // When the agent sent that report (0 for sweeps)
+    long long queued_us;        // When the task entered its current queue
+} PoliceTask;
+
+// One lane of a stage queue: any number of producers, one consumer, no locks
+typedef struct {
+    struct {
+        atomic_uint sequence;
+        PoliceTask task;
+    } cells[POLICE_QUEUE_CAPACITY];
+    atomic_uint tail;
+    unsigned int head;          // Consumer only
+} PoliceRing;
+
+// Bounded queue between two pipeline stages, one ring per lane
+typedef struct {
+    PoliceRing lanes[POLICE_LANES];
+    sem_t ready;                // Posted for every task pushed
+    PoliceStage stage;          // Stage the queue feeds
+} PoliceQueue;
+
+struct Police;
+struct SharedState;
+
+// One police worker of the aggregation stage. It owns the gangs with
+// gang_id % num_shards == index and their reports. Only the shard's thread
+// touches its report store, so the store needs no lock.
 typedef struct {
-    // Intelligence reports
-    IntelligenceReport* reports;
-    int report_capacity;
+    int index;
+    struct Police* police;
+    pthread_t thread;
+    
+    // Reports routed here by the ingestion thread, one ring per lane (single
+    // producer, single consumer each)
+    RoutedReport inbox[POLICE_LANES][POLICE_SHARD_INBOX];
+    atomic_uint inbox_head[POLICE_LANES];
+    atomic_uint inbox_tail[POLICE_LANES];
+    sem_t inbox_ready;          // Posted for every report put into the inbox
+    
+    // Gangs whose reports the decision stage wants cleared, one bit each
+    atomic_ullong clear_gangs[(POLICE_MAX_GANGS + 63) / 64];
+    
+    // Intelligence reports, oldest first
+    StoredReport* reports;
+    StoredReport* last_report;
+    ObjectPool report_pool;
     int num_reports;
     
-    // Statistics
-    int thwarted_missions;
-    int total_agents;
-    int lost_agents;
+    // Sweeps of the reports (the periodic monitoring pass)
+    long long next_sweep_us;
+    int sweeps;
+} PoliceShard;
+
+// Police structure
+typedef struct Police {
+    PoliceShard* shards;
+    int num_shards;
+    int partition;              // Report partition this police process consumes
+    
+    // Decision and arrest stages
+    PoliceQueue decisions;
+    PoliceQueue arrests;
+    pthread_t decision_thread;
+    pthread_t arrest_thread;
     
-    // Synchronization
-    pthread_mutex_t police_mutex;
-    pthread_cond_t police_cond;
+    // Statistics, merged from the stages with atomic adds
+    atomic_int thwarted_missions;
+    atomic_int total_agents;
+    atomic_int lost_agents;
+    atomic_int backlog;         // Reports held by all shards together
+    
+    atomic_bool running;        // Cleared by stop_police to end the stage threads
     
     // IPC mechanism for reports from agents
     int report_queue_id;  // Message queue ID
+    
+    // Shared state the arrest stage writes, attached once when it starts
+    struct SharedState* shm;
+    int sem_id;
+    
+    SimulationConfig config;
 } Police;
 
 // Function prototypes
-void initialize_police(Police* police, SimulationConfig config);
-void process_intelligence(Police* police, IntelligenceReport report, SimulationConfig config);
-bool decide_on_action(Police* police, int gang_id, SimulationConfig config);
+bool initialize_police(Police* police, int partition, int num_shards, SimulationConfig config);
+bool route_intelligence(Police* police, IntelligenceReport report, long long sent_us);
+void process_intelligence(PoliceShard* shard, IntelligenceReport report, SimulationConfig config);
+bool decide_on_action(const PoliceTask* evidence, SimulationConfig config);
 void arrest_gang_members(Police* police, int gang_id, SimulationConfig config);
 void submit_report(IntelligenceReport report, int queue_id);
-void* police_routine(void* arg);
+void* police_shard_routine(void* arg);
+void* police_decision_routine(void* arg);
+void* police_arrest_routine(void* arg);
+void stop_police(Police* police);
 void cleanup_police(Police* police);
 
 #endif /* POLICE_H */
@@ -0,0 +1,37 @@
+#ifndef RENDER_BATCH_H
+#define RENDER_BATCH_H
+
+#include <stdbool.h>
+
+// Retained-mode 2D renderer for the dashboard.
+//
+// Draw calls made between render_batch_begin() and render_batch_flush() only
+// append vertices to client-side arrays. The flush uploads them into vertex
+// buffers and draws the whole frame with one call per primitive type, so the
+// cost of a frame no longer grows with the number of glBegin/glEnd pairs.
+// Text is drawn as textured quads from a glyph atlas rasterized once from the
+// GLUT bitmap fonts (offscreen when framebuffer objects are available). Until
+// the atlas exists, text is drawn with the GLUT bitmap fonts directly.
+
+// Fonts available in the glyph atlas
+typedef enum {
+    FONT_HELVETICA_12,
+    FONT_HELVETICA_18,
+    FONT_FIXED_8_BY_13,
+    NUM_FONTS
+} FontId;
+
+// Function prototypes
+void render_batch_begin(int window_width, int window_height);
+void render_batch_flush();
+void render_batch_cleanup();
+
+void render_set_color(float r, float g, float b, float a);
+void render_quad(float x0, float y0, float x1, float y1);
+void render_triangle(float x1, float y1, float x2, float y2, float x3, float y3);
+void render_line(float x1, float y1, float x2, float y2);
+void render_circle(float cx, float cy, float radius);
+void render_text(FontId font, float x, float y, const char* text);
+int render_text_width(FontId font, const char* text);
+
+#endif /* RENDER_BATCH_H */
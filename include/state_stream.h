@@ -0,0 +1,63 @@
+#ifndef STATE_STREAM_H
+#define STATE_STREAM_H
+
+#include "config.h"
+#include "ipc.h"
+
+// Binary state stream (crime_sim --stream).
+//
+// A side process samples shared memory every STREAM_INTERVAL_MS and serves the
+// result on the unix socket STREAM_SOCKET. Every client first receives a full
+// snapshot, then one delta frame per tick in which something changed, carrying
+// only the changed fields. Clients never backpressure the simulation: a client
+// that falls behind has its pending deltas replaced by a fresh snapshot once its
+// backlog drains, and a client that stops reading altogether is dropped.
+//
+// Every frame starts with a 16 byte header, integers little-endian:
+//   u32 magic (STREAM_MAGIC), u8 type, u8 reserved, u16 reserved,
+//   u32 tick, u32 payload length
+//
+// Payload integers are unsigned LEB128 varints ("v" below).
+//
+// Snapshot payload:
+//   v num_gangs, v successful, v thwarted, v executed, u8 running
+//   per gang in id order: u8 flags, v prison_time, v preparation, v target,
+//                         v members, v agents
+//
+// Delta payload:
+//   u8 counter mask, then v value for every STREAM_COUNTER_* bit set
+//   v changed gangs
+//   per changed gang in id order: v id gap (id - previous id - 1, first gap
+//   counts from -1), u8 field mask, then the value for every STREAM_FIELD_*
+//   bit set, lowest bit first (u8 for flags, v for the rest)
+
+#define STREAM_MAGIC 0x31535343u        // "CSS1"
+#define STREAM_HEADER_SIZE 16
+
+// Frame types
+#define STREAM_FRAME_SNAPSHOT 1
+#define STREAM_FRAME_DELTA 2
+
+// Gang flag bits
+#define STREAM_FLAG_ACTIVE 0x01
+#define STREAM_FLAG_IN_PRISON 0x02
+
+// Delta field mask bits
+#define STREAM_FIELD_FLAGS 0x01
+#define STREAM_FIELD_PRISON_TIME 0x02
+#define STREAM_FIELD_PREPARATION 0x04
+#define STREAM_FIELD_TARGET 0x08
+#define STREAM_FIELD_MEMBERS 0x10
+#define STREAM_FIELD_AGENTS 0x20
+
+// Delta counter mask bits
+#define STREAM_COUNTER_SUCCESSFUL 0x01
+#define STREAM_COUNTER_THWARTED 0x02
+#define STREAM_COUNTER_EXECUTED 0x04
+#define STREAM_COUNTER_RUNNING 0x08
+#define STREAM_COUNTER_NUM_GANGS 0x10
+
+// Function prototypes
+void run_state_stream(SimulationConfig config, SharedState* shm);
+
+#endif /* STATE_STREAM_H */
@@ -0,0 +1,27 @@
+#ifndef TERM_DASHBOARD_H
+#define TERM_DASHBOARD_H
+
+#include <stdbool.h>
+#include "config.h"
+#include "visualization.h"
+
+// Terminal dashboard for headless runs.
+//
+// Keeps a cell buffer of the frame currently on screen and, for each new
+// frame, writes only the cells that changed - cursor moves, colors and
+// characters batched into a single write(). The dashboard owns the terminal
+// while it runs: stdout and stderr of every process are redirected to a log
+// file, so it must be started before any child process is forked.
+//
+// Keys: j/k or arrows scroll, PgUp/PgDn page, g/G jump to top/bottom,
+// s cycles the sort column, r reverses the sort order, l switches the
+// preparation history between its resolutions, q quits.
+
+// Function prototypes
+bool term_dashboard_start(const char* log_file);
+void term_dashboard_stop();
+bool term_dashboard_active();
+bool term_dashboard_wait_input(int timeout_ms);
+void term_dashboard_draw(const VisSnapshot* snapshot, const SimulationConfig* config);
+
+#endif /* TERM_DASHBOARD_H */
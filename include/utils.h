@@ -8,12 +8,46 @@
 #include <sys/time.h>
 #include "config.h"
 
+// Bump arena for scratch that dies together, such as one tick's or one
+// investigation's buffers. arena_reset frees everything at once. A round that
+// does not fit spills into heap blocks, and the next reset grows the arena to
+// that round's size, so steady-state rounds never touch the heap.
+typedef struct {
+    char* base;
+    size_t capacity;
+    size_t used;
+    size_t round_size;          // Bytes handed out this round, spills included
+    void* spills;               // Heap blocks of this round that did not fit
+} Arena;
+
+// Pool of fixed-size records (reports, events) recycled through a free list.
+// Slabs are only added, never moved, so records keep their address.
+typedef struct {
+    size_t object_size;
+    int objects_per_slab;
+    void* slabs;
+    void* free_list;
+    int in_use;
+} ObjectPool;
+
 // Function prototypes
 int random_int(int min, int max);
 double random_double(double min, double max);
 bool random_event(int probability_percentage);
 void delay_ms(int milliseconds);
+long long monotonic_time_us();
 void log_message(const char* format, ...);
 const char* crime_type_to_string(CrimeType type);
+bool crime_is_high_risk(CrimeType type);
+
+bool arena_init(Arena* arena, size_t capacity);
+void* arena_alloc(Arena* arena, size_t size);
+void arena_reset(Arena* arena);
+void arena_destroy(Arena* arena);
+
+void pool_init(ObjectPool* pool, size_t object_size, int objects_per_slab);
+void* pool_get(ObjectPool* pool);
+void pool_put(ObjectPool* pool, void* object);
+void pool_destroy(ObjectPool* pool);
 
 #endif /* UTILS_H */
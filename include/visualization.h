@@ -4,6 +4,7 @@
 #include <GL/glut.h>
 #include <stdbool.h>
 #include <pthread.h>  // Add this for pthread_mutex_t
+#include <stdatomic.h>
 #include "config.h"
 #include "ipc.h"
 
@@ -23,6 +24,24 @@ typedef struct {
     bool is_active;
 } GangVisState;
 
+// Everything one dashboard frame draws, captured at a single point in time.
+// The updater publishes snapshots and the renderer draws them without locking.
+typedef struct {
+    unsigned int sequence;           // Publish sequence number
+    int num_gangs;                   // Entries in gang_states
+    GangVisState* gang_states;       // Per-gang state
+    int total_successful_missions;
+    int total_thwarted_missions;
+    int total_executed_agents;
+    bool simulation_running;         // Simulation state when captured
+    float animation_time;
+    int* member_counts;              // Member rows copied per gang, -1 if not copied
+    GangMemberRecord* members;       // MAX_SHARED_MEMBERS rows per gang, copied for expanded gangs only
+    int history_level;               // History resolution level copied
+    bool* has_history;               // Per gang: history was recorded
+    HistoryBucket* history;          // HISTORY_METRICS x HISTORY_BUCKETS buckets per gang, oldest first
+} VisSnapshot;
+
 // Visualization context structure
 typedef struct {
     Gang* gangs;                 // Gangs in the simulation
@@ -44,6 +63,10 @@ typedef struct {
     int target_list_scroll;      // Current scroll position for target list
     // M-2: Gang expansion to view member details
     bool* expanded_gangs;        // Array to track expanded/collapsed gangs
+    atomic_uint expansion_version; // Bumped when gangs are expanded or collapsed
+    atomic_int history_level;    // History resolution shown by the sparklines
+    // Change-driven redraw: bumped whenever viewer-side data changes or the user interacts
+    atomic_uint data_version;
 } VisualizationContext;
 
 // Global visualization context
@@ -59,16 +82,34 @@ void special_key_function(int key, int x, int y);     // M-2, M-3: Special keys
 void mouse_function(int button, int state, int x, int y); // F-2: Mouse handler for gang expansion
 void passive_motion_function(int x, int y);             // F-6: Track mouse for hover effects
 void idle_function();
+void visualization_mark_dirty();                        // Request a redraw after a data change
 void draw_gangs(VisualizationContext* ctx);
 void draw_police(VisualizationContext* ctx);
 void draw_stats(VisualizationContext* ctx);
-void draw_status_bar(VisualizationContext* ctx);
+void draw_status_bar(VisualizationContext* ctx, const VisSnapshot* snapshot);
 
 // New dashboard layout functions - modified to take coordinates and dimensions
-void draw_gang_list(int x, int y, int width, int height);
-void draw_current_target(int x, int y, int width, int height);
-void draw_counters(int x, int y, int width, int height);
+void draw_gang_list(const VisSnapshot* snapshot, int x, int y, int width, int height);
+void draw_current_target(const VisSnapshot* snapshot, int x, int y, int width, int height);
+void draw_counters(const VisSnapshot* snapshot, int x, int y, int width, int height);
 void draw_debug_info(VisualizationContext* ctx);
 void cleanup_visualization();
 
+// Per-gang viewer state (gang_states and expanded_gangs), before initialize_visualization
+bool viewer_state_init(int num_gangs);
+void viewer_state_cleanup();
+
+// Viewer loops shared by crime_sim and crime_view
+void* visualization_thread_func(void* arg);             // Text dashboard, or GL bookkeeping
+void visualization_publish_snapshot();                  // Publish the updater's gang states
+bool visualization_details_changed();                   // Member tables or sparklines need a new snapshot
+void visualization_cycle_history_level();               // Switch sparklines to the next resolution
+
+// Lock-free snapshot hand-off (single producer, single consumer)
+bool vis_snapshot_init(int num_gangs);
+void vis_snapshot_cleanup();
+VisSnapshot* vis_snapshot_back_buffer();        // Producer: buffer to fill
+void vis_snapshot_publish();                    // Producer: publish the filled buffer
+const VisSnapshot* vis_snapshot_acquire();      // Consumer: newest published snapshot
+
 #endif /* VISUALIZATION_H */
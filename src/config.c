@@ -3,6 +3,7 @@
 #include <string.h>
 #include <ctype.h>
 #include "../include/config.h"
+#include "../include/investigation.h"
 
 // Function to trim whitespace from a string
 static char* trim(char* str) {
@@ -40,6 +41,10 @@ SimulationConfig load_config(const char* config_file) {
     config.min_members_per_gang = 5;
     config.max_members_per_gang = 10;
     config.gang_ranks = 5;
+    config.gang_hosts = 0;
+    config.member_tick_ms = 500;
+    config.tip_fanout = 0;
+    strcpy(config.placement, "none");
     config.preparation_time_min = 5;
     config.preparation_time_max = 20;
     config.min_preparation_level = 70;
@@ -48,8 +53,14 @@ SimulationConfig load_config(const char* config_file) {
     config.agent_infiltration_success_rate = 60;
     config.agent_suspicion_threshold = 75;
     config.police_action_threshold = 80;
+    config.police_processes = 1;
+    config.police_threads = 0;
     config.truth_gain = 10;        // Default knowledge gain
     config.false_penalty = 5;      // Default knowledge penalty
+    config.outbox_flush_ms = 1000;
+    strcpy(config.investigation_scoring, DEFAULT_INVESTIGATION_SCORING);
+    config.investigation_threshold = 30;
+    config.investigation_top_k = 3;
     config.mission_success_rate_base = 50;
     config.member_death_probability = 10;
     config.prison_time_min = 5;
@@ -58,6 +69,12 @@ SimulationConfig load_config(const char* config_file) {
     config.max_successful_plans = 15;
     config.max_executed_agents = 5;
     config.visualization_refresh_rate = 1000;
+    strcpy(config.terminal_log_file, "crime_sim.log");
+    config.metrics_interval_ms = 1000;
+    strcpy(config.metrics_file, "crime_sim.prom");
+    strcpy(config.metrics_socket, "/tmp/crime_sim_metrics.sock");
+    config.stream_interval_ms = 100;
+    strcpy(config.stream_socket, "/tmp/crime_sim_stream.sock");
     
     // Parse configuration file
     char line[256];
@@ -96,6 +113,36 @@ SimulationConfig load_config(const char* config_file) {
         else if (strcmp(key, "GANG_RANKS") == 0) {
             config.gang_ranks = atoi(value);
         }
+        else if (strcmp(key, "GANG_HOSTS") == 0) {
+            config.gang_hosts = atoi(value);
+        }
+        else if (strcmp(key, "TIP_FANOUT") == 0) {
+            config.tip_fanout = atoi(value);
+        }
+        else if (strcmp(key, "MEMBER_TICK_MS") == 0) {
+            config.member_tick_ms = atoi(value);
+        }
+        else if (strcmp(key, "PLACEMENT") == 0) {
+            snprintf(config.placement, sizeof(config.placement), "%s", value);
+        }
+        else if (strcmp(key, "POLICE_PROCESSES") == 0) {
+            config.police_processes = atoi(value);
+        }
+        else if (strcmp(key, "POLICE_THREADS") == 0) {
+            config.police_threads = atoi(value);
+        }
+        else if (strcmp(key, "OUTBOX_FLUSH_MS") == 0) {
+            config.outbox_flush_ms = atoi(value);
+        }
+        else if (strcmp(key, "INVESTIGATION_SCORING") == 0) {
+            snprintf(config.investigation_scoring, sizeof(config.investigation_scoring), "%s", value);
+        }
+        else if (strcmp(key, "INVESTIGATION_THRESHOLD") == 0) {
+            config.investigation_threshold = atoi(value);
+        }
+        else if (strcmp(key, "INVESTIGATION_TOP_K") == 0) {
+            config.investigation_top_k = atoi(value);
+        }
         else if (strcmp(key, "PREPARATION_TIME_MIN") == 0) {
             config.preparation_time_min = atoi(value);
         }
@@ -150,6 +197,24 @@ SimulationConfig load_config(const char* config_file) {
         else if (strcmp(key, "VISUALIZATION_REFRESH_RATE") == 0) {
             config.visualization_refresh_rate = atoi(value);
         }
+        else if (strcmp(key, "TERMINAL_LOG_FILE") == 0) {
+            snprintf(config.terminal_log_file, sizeof(config.terminal_log_file), "%s", value);
+        }
+        else if (strcmp(key, "METRICS_INTERVAL_MS") == 0) {
+            config.metrics_interval_ms = atoi(value);
+        }
+        else if (strcmp(key, "METRICS_FILE") == 0) {
+            snprintf(config.metrics_file, sizeof(config.metrics_file), "%s", value);
+        }
+        else if (strcmp(key, "METRICS_SOCKET") == 0) {
+            snprintf(config.metrics_socket, sizeof(config.metrics_socket), "%s", value);
+        }
+        else if (strcmp(key, "STREAM_INTERVAL_MS") == 0) {
+            config.stream_interval_ms = atoi(value);
+        }
+        else if (strcmp(key, "STREAM_SOCKET") == 0) {
+            snprintf(config.stream_socket, sizeof(config.stream_socket), "%s", value);
+        }
     }
     
     fclose(file);
@@ -163,18 +228,41 @@ void print_config(SimulationConfig config) {
     printf("  - Number of gangs: %d-%d\n", config.min_gangs, config.max_gangs);
     printf("  - Members per gang: %d-%d\n", config.min_members_per_gang, config.max_members_per_gang);
     printf("  - Number of ranks: %d\n", config.gang_ranks);
+    if (config.gang_hosts > 0) {
+        printf("  - Gang hosts: %d\n", config.gang_hosts);
+    } else {
+        printf("  - Gang hosts: one per core\n");
+    }
+    printf("  - Member tick: %d ms\n", config.member_tick_ms);
     
     printf("\nCrime Planning:\n");
     printf("  - Preparation time: %d-%d time units\n", config.preparation_time_min, config.preparation_time_max);
     printf("  - Required preparation level: %d-%d%%\n", config.min_preparation_level, config.max_preparation_level);
     printf("  - False information probability: %d%%\n", config.false_info_probability);
+    if (config.tip_fanout > 0) {
+        printf("  - Tips per member and tick: %d\n", config.tip_fanout);
+    } else {
+        printf("  - Tips per member and tick: every other member\n");
+    }
     
     printf("\nSecret Agents:\n");
     printf("  - Infiltration success rate: %d%%\n", config.agent_infiltration_success_rate);
     printf("  - Suspicion threshold: %d%%\n", config.agent_suspicion_threshold);
     printf("  - Police action threshold: %d%%\n", config.police_action_threshold);
+    printf("  - Police processes: %d\n", config.police_processes);
+    if (config.police_threads > 0) {
+        printf("  - Police shards: %d\n", config.police_threads);
+    } else {
+        printf("  - Police shards: one per core\n");
+    }
     printf("  - Truth gain: %d\n", config.truth_gain);
     printf("  - False penalty: %d\n", config.false_penalty);
+    printf("  - Report outbox flush: %d ms\n", config.outbox_flush_ms);
+    
+    printf("\nGang Investigations:\n");
+    printf("  - Scoring: %s\n", config.investigation_scoring);
+    printf("  - Suspect threshold: %d\n", config.investigation_threshold);
+    printf("  - Interrogations per investigation: %d\n", config.investigation_top_k);
     
     printf("\nMission Outcomes:\n");
     printf("  - Base mission success rate: %d%%\n", config.mission_success_rate_base);
@@ -186,7 +274,20 @@ void print_config(SimulationConfig config) {
     printf("  - Max successful plans: %d\n", config.max_successful_plans);
     printf("  - Max executed agents: %d\n", config.max_executed_agents);
     
+    printf("\nPlacement:\n");
+    printf("  - Policy: %s\n", config.placement);
+    
     printf("\nVisualization:\n");
     printf("  - Refresh rate: %d ms\n", config.visualization_refresh_rate);
+    printf("  - Terminal dashboard log: %s\n", config.terminal_log_file);
+    
+    printf("\nMetrics:\n");
+    printf("  - Export interval: %d ms\n", config.metrics_interval_ms);
+    printf("  - Export file: %s\n", config.metrics_file);
+    printf("  - Export socket: %s\n", config.metrics_socket);
+    
+    printf("\nState Stream:\n");
+    printf("  - Sample interval: %d ms\n", config.stream_interval_ms);
+    printf("  - Socket: %s\n", config.stream_socket);
     printf("==============================\n\n");
 }
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include "../include/config.h"
+#include "../include/ipc.h"
+#include "../include/utils.h"
+#include "../include/visualization.h"
+#include "../include/term_dashboard.h"
+#include "../include/lock_profile.h"
+#include "../include/ingest.h"
+#include "../include/placement.h"
+
+// Standalone read-only viewer.
+//
+// Attaches to the shared memory of a running simulation (selected by run id)
+// without write access and shows the GL dashboard, or the terminal dashboard
+// when there is no display. Viewers never touch the simulation's queues or
+// semaphores, so any number of them can come and go while it runs.
+
+static SharedState* viewed_state = NULL;
+
+// Leave on Ctrl-C / q - the terminal is restored by the dashboard's exit handler
+static void viewer_signal_handler(int sig) {
+    exit(0);
+}
+
+// Detach from the simulation on exit
+static void detach_viewer() {
+    if (viewed_state != NULL) {
+        detach_shared_memory(viewed_state);
+        viewed_state = NULL;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* config_file = "config/simulation_config.txt";
+    bool force_text = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            force_text = true;
+        }
+        else if (strncmp(argv[i], "--run-id=", 9) == 0) {
+            ipc_run_id = atoi(argv[i] + 9);
+            if (ipc_run_id < 0 || ipc_run_id > MAX_RUN_ID) {
+                fprintf(stderr, "Run id must be between 0 and %d\n", MAX_RUN_ID);
+                return 1;
+            }
+        }
+        else if (argv[i][0] == '-') {
+            printf("Usage: %s [config_file] [--run-id=N] [--text]\n", argv[0]);
+            return 1;
+        }
+        else {
+            config_file = argv[i];
+        }
+    }
+
+    // Limits shown next to the counters come from the simulation's configuration
+    SimulationConfig config = load_config(config_file);
+    
+    // Viewers share the CPU the simulation keeps for its own renderer
+    placement_init(config.placement);
+    placement_pin_thread(PLACEMENT_ROLE_VIEWER, 0);
+
+    // Locate the running simulation
+    int shm_id = shmget(RUN_KEY(SHARED_MEMORY_KEY), 0, 0);
+    if (shm_id == -1) {
+        fprintf(stderr, "No simulation with run id %d is running\n", ipc_run_id);
+        return 1;
+    }
+    viewed_state = attach_shared_memory_readonly(shm_id);
+    if (viewed_state == NULL) {
+        return 1;
+    }
+    atexit(detach_viewer);
+
+    int num_gangs = viewed_state->num_gangs;
+    if (num_gangs <= 0 || num_gangs > MAX_SHARED_GANGS) {
+        fprintf(stderr, "Simulation run %d has not started its gangs yet\n", ipc_run_id);
+        return 1;
+    }
+
+    signal(SIGINT, viewer_signal_handler);
+    signal(SIGTERM, viewer_signal_handler);
+
+    // Viewer-side visualization context
+    viz_context.gangs = NULL;
+    viz_context.num_gangs = num_gangs;
+    viz_context.police = NULL;
+    viz_context.config = config;
+    viz_context.simulation_running = true;
+    viz_context.refresh_rate = config.visualization_refresh_rate;
+    viz_context.shared_state = viewed_state;
+    viz_context.viz_thread_running = false;
+    viz_context.viz_thread_health = 0;
+    viz_context.animation_time = 0.0f;
+
+    if (pthread_mutex_init(&viz_context.mutex, NULL) != 0) {
+        perror("Failed to initialize visualization mutex");
+        return 1;
+    }
+
+    if (!viewer_state_init(num_gangs) || !vis_snapshot_init(num_gangs)) {
+        perror("Failed to allocate viewer state");
+        return 1;
+    }
+    for (int i = 0; i < num_gangs; i++) {
+        viz_context.gang_states[i].id = i;
+        viz_context.gang_states[i].is_active = true;
+    }
+
+    // GL dashboard when a display is available, terminal dashboard otherwise
+    if (force_text) {
+        unsetenv("DISPLAY");
+    }
+    char* display = getenv("DISPLAY");
+    bool graphical = display && strlen(display) > 0;
+    if (graphical) {
+        initialize_visualization(&argc, argv, &viz_context);
+    } else {
+        // The viewer prints nothing while the dashboard runs, so no log file is needed
+        term_dashboard_start(NULL);
+    }
+
+    // Snapshots are built from the gangs' shared-memory records
+    if (!ingest_start()) {
+        return 1;
+    }
+    atexit(ingest_stop);
+
+    if (graphical) {
+        pthread_t viz_thread;
+        if (pthread_create(&viz_thread, NULL, visualization_thread_func, NULL) == 0) {
+            pthread_detach(viz_thread);
+        }
+        glutMainLoop();
+    } else {
+        visualization_thread_func(NULL);
+    }
+
+    return 0;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,9 +8,27 @@
 #include "../include/gang.h"
 #include "../include/utils.h"
 #include "../include/ipc.h"
+#include "../include/lock_profile.h"
+#include "../include/mailbox.h"
+#include "../include/outbox.h"
 
 // Original deliver_truth function removed - using the new version with false_info_probability parameter
 
+// Copy the members' state into the back view and make it the one read next tick
+static void publish_member_views(Gang* gang) {
+    MemberView* back = gang->member_views[1 - gang->front_view];
+    
+    pthread_rwlock_rdlock(&gang->member_lock);
+    for (int i = 0; i < gang->num_members; i++) {
+        back[i].rank = gang->members[i].rank;
+        back[i].alive = gang->members[i].alive;
+        back[i].in_prison = gang->members[i].in_prison;
+    }
+    pthread_rwlock_unlock(&gang->member_lock);
+    
+    gang->front_view = 1 - gang->front_view;
+}
+
 // Initialize a gang
 void initialize_gang(Gang* gang, int id, int num_members, int num_ranks, SimulationConfig config) {
     gang->id = id;
@@ -24,12 +43,20 @@ void initialize_gang(Gang* gang, int id, int num_members, int num_ranks, Simulat
     gang->false_info_probability = config.false_info_probability;
     gang->truth_gain = config.truth_gain;
     gang->false_penalty = config.false_penalty;
+    gang->tip_fanout = config.tip_fanout;
     gang->report_queue_id = -1; // Will be set by the main process
     
     // Initialize mutex and condition variable
     pthread_mutex_init(&gang->gang_mutex, NULL);
     pthread_cond_init(&gang->gang_cond, NULL);
     
+    // Member ticks share the member lock; gang-wide operations must not starve behind them
+    pthread_rwlockattr_t member_lock_attr;
+    pthread_rwlockattr_init(&member_lock_attr);
+    pthread_rwlockattr_setkind_np(&member_lock_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&gang->member_lock, &member_lock_attr);
+    pthread_rwlockattr_destroy(&member_lock_attr);
+    
     // Allocate members
     gang->members = (GangMember*)malloc(num_members * sizeof(GangMember));
     
@@ -37,152 +64,247 @@ void initialize_gang(Gang* gang, int id, int num_members, int num_ranks, Simulat
     for (int i = 0; i < num_members; i++) {
         gang->members[i].id = i;
         gang->members[i].rank = i % num_ranks;  // Distribute ranks evenly at first
-        gang->members[i].preparation_level = 0;
-        gang->members[i].knowledge_rate = 0;
+        atomic_init(&gang->members[i].preparation_level, 0);
+        atomic_init(&gang->members[i].knowledge, 0);
+        atomic_init(&gang->members[i].knowledge_rate, 0);
         gang->members[i].suspicion = 0;
         gang->members[i].alive = true;
         gang->members[i].in_prison = false;
         gang->members[i].gang_ptr = gang;
         
+        // Room for a tip from every other member per tick
+        mailbox_init(&gang->members[i].inbox[0], num_members);
+        mailbox_init(&gang->members[i].inbox[1], num_members);
+        
         // Determine if this member is a secret agent
         gang->members[i].is_secret_agent = random_event(config.agent_infiltration_success_rate);
     }
     
+    // Investigations run without allocating once the scratch fits the gang
+    investigation_init(&gang->investigation, num_members);
+    
     // Store process ID
     gang->pid = getpid();
     
     // Plan initial mission
+    gang->mission = 0;
     plan_new_mission(gang, config);
     
-    // Create threads for gang members
+    // Lock-step ticks: the members plus the leader meet at both barriers
+    gang->tick = 0;
+    gang->tick_running = true;
+    gang->tick_interval_ms = config.member_tick_ms;
+    pthread_barrier_init(&gang->tick_start, NULL, num_members + 1);
+    pthread_barrier_init(&gang->tick_end, NULL, num_members + 1);
+    gang->member_views[0] = (MemberView*)malloc(num_members * sizeof(MemberView));
+    gang->member_views[1] = (MemberView*)malloc(num_members * sizeof(MemberView));
+    gang->front_view = 0;
+    publish_member_views(gang);
+    
+    // Create threads for gang members and the leader driving them
     for (int i = 0; i < num_members; i++) {
         pthread_create(&gang->members[i].thread, NULL, gang_member_routine, &gang->members[i]);
     }
+    pthread_create(&gang->leader_thread, NULL, gang_leader_routine, gang);
     
     log_message("Gang %d initialized with %d members and %d ranks", id, num_members, num_ranks);
 }
 
-// Gang member thread routine
-void* gang_member_routine(void* arg) {
-    GangMember* member = (GangMember*)arg;
-    Gang* gang = (Gang*)member->gang_ptr;
+// Update a member's knowledge for one tip it received
+static void apply_tip(Gang* gang, bool is_secret_agent, bool truthful, int* knowledge, int* knowledge_rate) {
+    // For secret agents, update their knowledge based on truth/falsehood
+    if (is_secret_agent) {
+        // R-6: Knowledge Accumulation with configurable truth gain and false penalty
+        if (truthful) {
+            // Received true information, increases knowledge by truth_gain
+            *knowledge += gang->truth_gain;
+            // Also update knowledge_rate for backward compatibility
+            *knowledge_rate += gang->truth_gain;
+        } else {
+            // Received false information, decreases knowledge by false_penalty
+            *knowledge -= gang->false_penalty;
+            // Also update knowledge_rate for backward compatibility
+            *knowledge_rate -= gang->false_penalty;
+        }
+        
+        // R-5: Agents are unaware of each other - treat all members as regular members
+        // Secret agent doesn't know if the other member is an agent too
+        
+        // Ensure knowledge stays within bounds
+        if (*knowledge < 0) {
+            *knowledge = 0;
+        } else if (*knowledge > 100) {
+            *knowledge = 100;
+        }
+        
+        // Ensure knowledge_rate stays within bounds for backward compatibility
+        if (*knowledge_rate < 0) {
+            *knowledge_rate = 0;
+        } else if (*knowledge_rate > 100) {
+            *knowledge_rate = 100;
+        }
+    } else {
+        // For regular members, just adjust their knowledge normally
+        if (truthful) {
+            *knowledge += 5;
+        } else {
+            *knowledge -= 3;
+        }
+        
+        // Ensure knowledge stays within bounds
+        if (*knowledge < 0) {
+            *knowledge = 0;
+        } else if (*knowledge > 100) {
+            *knowledge = 100;
+        }
+    }
+}
+
+// Post this tick's tips to other members' mailboxes, deciding at send time
+// whether each one is true. Tips arrive in the inbox the receiver drains next tick.
+static void send_tips(GangMember* member, Gang* gang, const MemberView* views) {
+    int inbox = (gang->tick + 1) % 2;
+    int num_members = gang->num_members;
+    int fanout = gang->tip_fanout;
+    if (fanout <= 0 || fanout >= num_members - 1) {
+        fanout = 0;     // Everyone
+    }
+    
+    int sent = 0;
+    for (int n = 0; n < num_members; n++) {
+        // Every other member in turn, or randomly chosen ones
+        int i = fanout == 0 ? n : random_int(0, num_members - 1);
+        if (fanout > 0 && sent >= fanout) break;
+        if (i == member->id) continue; // Skip self
+        
+        // Only talk to active members
+        if (!views[i].alive || views[i].in_prison) continue;
+        
+        Tip tip;
+        tip.sender = member->id;
+        tip.sender_rank = member->rank;
+        tip.truthful = deliver_truth(member->rank, views[i].rank, gang->false_info_probability);
+        mailbox_post(&gang->members[i].inbox[inbox], tip);
+        sent++;
+    }
+}
+
+// One member's work in a tick. Peers are read from the views published at the
+// end of the previous tick, and tips posted during a tick are only read in the
+// next one, so the outcome does not depend on member order.
+// Runs under the shared member lock: members of a gang work in parallel and
+// each writes only its own fields, gang-wide operations wait for the tick.
+static void member_tick(GangMember* member, Gang* gang, const MemberView* views) {
+    pthread_rwlock_rdlock(&gang->member_lock);
+    
+    // Work on private copies of the member's own fields, published once at the end
+    int preparation_level = atomic_load_explicit(&member->preparation_level, memory_order_relaxed);
+    int knowledge = atomic_load_explicit(&member->knowledge, memory_order_relaxed);
+    int knowledge_rate = atomic_load_explicit(&member->knowledge_rate, memory_order_relaxed);
+    
+    // Knowledge exchange happens for all members
+    // For regular members, this is just normal gang communication
+    // For secret agents, this represents intelligence gathering
+    Tip tip;
+    while (mailbox_take(&member->inbox[gang->tick % 2], &tip)) {
+        apply_tip(gang, member->is_secret_agent, tip.truthful, &knowledge, &knowledge_rate);
+    }
     
-    while (gang->is_active) {
-        // Wait if gang is in prison
-        pthread_mutex_lock(&gang->gang_mutex);
-        while (gang->is_in_prison) {
-            pthread_cond_wait(&gang->gang_cond, &gang->gang_mutex);
+    // Increase preparation level
+    if (preparation_level < gang->required_preparation_level) {
+        // Higher rank members prepare faster
+        int preparation_step = 5 + (member->rank * 2); // Increased step size to make progress visible
+        preparation_level += preparation_step;
+        
+        if (preparation_level > gang->required_preparation_level) {
+            preparation_level = gang->required_preparation_level;
         }
-        pthread_mutex_unlock(&gang->gang_mutex);
         
-        // Increase preparation level
-        pthread_mutex_lock(&gang->gang_mutex);
-        if (member->preparation_level < gang->required_preparation_level) {
-            // Higher rank members prepare faster
-            int preparation_step = 5 + (member->rank * 2); // Increased step size to make progress visible
-            member->preparation_level += preparation_step;
-            
-            if (member->preparation_level > gang->required_preparation_level) {
-                member->preparation_level = gang->required_preparation_level;
-            }
-            
-            // Knowledge exchange happens for all members
-            // For regular members, this is just normal gang communication
-            // For secret agents, this represents intelligence gathering
+        // Members who are preparing pass information on to the others
+        send_tips(member, gang, views);
+        
+        // If member is a secret agent, potentially report to police
+        if (member->is_secret_agent) {
             
-            // Simulate information exchange with other members
-            // For each interaction, determine if truth or disinformation is shared
-            for (int i = 0; i < gang->num_members; i++) {
-                if (i == member->id) continue; // Skip self
-                
-                // Only interact with active members
-                if (!gang->members[i].alive || gang->members[i].in_prison) continue;
-                
-                // Determine if this member receives truth or disinformation
-                int sender_rank = gang->members[i].rank;
-                int receiver_rank = member->rank;
-                bool received_truth = deliver_truth(sender_rank, receiver_rank, gang->false_info_probability);
-                
-                // For secret agents, update their knowledge based on truth/falsehood
-                if (member->is_secret_agent) {
-                    // R-6: Knowledge Accumulation with configurable truth gain and false penalty
-                    if (received_truth) {
-                        // Received true information, increases knowledge by truth_gain
-                        member->knowledge += gang->truth_gain;
-                        // Also update knowledge_rate for backward compatibility
-                        member->knowledge_rate += gang->truth_gain;
-                    } else {
-                        // Received false information, decreases knowledge by false_penalty
-                        member->knowledge -= gang->false_penalty;
-                        // Also update knowledge_rate for backward compatibility
-                        member->knowledge_rate -= gang->false_penalty;
-                    }
-                    
-                    // R-5: Agents are unaware of each other - treat all members as regular members
-                    // Secret agent doesn't know if the other member is an agent too
+            // Report to police if suspicion is high enough
+            if (knowledge_rate >= gang->required_preparation_level / 2) {
+                // Create intelligence report
+                IntelligenceReport report;
+                    report.gang_id = gang->id;
+                    report.agent_id = member->id;
+                    report.suspected_target = gang->current_target;
+                    report.suspicion_level = knowledge_rate;
+                    report.is_reliable = member->rank > (gang->num_ranks / 2);
                     
-                    // Ensure knowledge stays within bounds
-                    if (member->knowledge < 0) {
-                        member->knowledge = 0;
-                    } else if (member->knowledge > 100) {
-                        member->knowledge = 100;
-                    }
-                    
-                    // Ensure knowledge_rate stays within bounds for backward compatibility
-                    if (member->knowledge_rate < 0) {
-                        member->knowledge_rate = 0;
-                    } else if (member->knowledge_rate > 100) {
-                        member->knowledge_rate = 100;
-                    }
-                } else {
-                    // For regular members, just adjust their knowledge normally
-                    if (received_truth) {
-                        member->knowledge += 5;
-                    } else {
-                        member->knowledge -= 3;
-                    }
-                    
-                    // Ensure knowledge stays within bounds
-                    if (member->knowledge < 0) {
-                        member->knowledge = 0;
-                    } else if (member->knowledge > 100) {
-                        member->knowledge = 100;
-                    }
-                }
-            }
-            
-            // If member is a secret agent, potentially report to police
-            if (member->is_secret_agent) {
-                
-                // Report to police if suspicion is high enough
-                if (member->knowledge_rate >= gang->required_preparation_level / 2) {
-                    // Create intelligence report
-                    IntelligenceReport report;
-                        report.gang_id = gang->id;
-                        report.agent_id = member->id;
-                        report.suspected_target = gang->current_target;
-                        report.suspicion_level = member->knowledge_rate;
-                        report.is_reliable = member->rank > (gang->num_ranks / 2);
-                        
-                        // Submit report to police through message queue
-                        int report_queue_id = gang->report_queue_id;
-                        if (report_queue_id > 0) {
-                            if (send_report(report_queue_id, report) == 0) {
-                                log_message("Agent %d in gang %d submitted a report with suspicion level %d", 
-                                           member->id, gang->id, member->knowledge_rate);
-                            } else {
-                                // If sending fails, we'll retry later
-                                log_message("Agent %d in gang %d failed to submit report - will retry later", 
-                                           member->id, gang->id);
-                            }
+                    // Hand the report to the process's outbox - never blocks the tick
+                    int report_queue_id = gang->report_queue_id;
+                    if (report_queue_id > 0) {
+                        // The sender thread logs the report once it is actually sent
+                        if (!outbox_post(report, gang->mission)) {
+                            // If sending fails, we'll retry later
+                            log_message("Agent %d in gang %d failed to submit report - will retry later", 
+                                       member->id, gang->id);
                         }
                     }
-            }
+                }
+        }
+    }
+    
+    atomic_store_explicit(&member->preparation_level, preparation_level, memory_order_relaxed);
+    atomic_store_explicit(&member->knowledge, knowledge, memory_order_relaxed);
+    atomic_store_explicit(&member->knowledge_rate, knowledge_rate, memory_order_relaxed);
+    
+    pthread_rwlock_unlock(&gang->member_lock);
+}
+
+// Gang member thread routine - one member_tick per tick released by the leader
+void* gang_member_routine(void* arg) {
+    GangMember* member = (GangMember*)arg;
+    Gang* gang = (Gang*)member->gang_ptr;
+    
+    while (1) {
+        pthread_barrier_wait(&gang->tick_start);
+        if (!gang->tick_running) break;
+        
+        member_tick(member, gang, gang->member_views[gang->front_view]);
+        
+        pthread_barrier_wait(&gang->tick_end);
+    }
+    
+    return NULL;
+}
+
+// Gang leader thread routine - drives the members in lock-step ticks. Between
+// tick_start and tick_end every member runs one member_tick; the leader then
+// publishes the new member views and waits for the next tick boundary.
+// Nothing runs while the gang is in prison.
+void* gang_leader_routine(void* arg) {
+    Gang* gang = (Gang*)arg;
+    
+    while (1) {
+        long long tick_begin = monotonic_time_us();
+        
+        // Wait out a prison term, or stop when the gang is shut down
+        sim_mutex_lock(&gang->gang_mutex);
+        while (gang->is_in_prison && gang->is_active) {
+            sim_cond_wait(&gang->gang_cond, &gang->gang_mutex);
         }
-        pthread_mutex_unlock(&gang->gang_mutex);
+        gang->tick_running = gang->is_active;
+        sim_mutex_unlock(&gang->gang_mutex);
         
-        // Sleep to avoid busy waiting
-        usleep(500000); // 0.5 seconds between actions
+        // Release the members, then wait for all of them to finish the tick
+        pthread_barrier_wait(&gang->tick_start);
+        if (!gang->tick_running) break;
+        pthread_barrier_wait(&gang->tick_end);
+        
+        publish_member_views(gang);
+        gang->tick++;
+        
+        // Fixed tick length; a tick that overran starts the next one right away
+        long long remaining_us = gang->tick_interval_ms * 1000LL - (monotonic_time_us() - tick_begin);
+        if (remaining_us > 0) {
+            usleep(remaining_us);
+        }
     }
     
     return NULL;
@@ -190,7 +312,9 @@ void* gang_member_routine(void* arg) {
 
 // Plan a new mission for the gang
 void plan_new_mission(Gang* gang, SimulationConfig config) {
-    pthread_mutex_lock(&gang->gang_mutex);
+    // Exclusive phase: no member tick runs while the mission changes
+    pthread_rwlock_wrlock(&gang->member_lock);
+    sim_mutex_lock(&gang->gang_mutex);
     
     // Reset preparation levels
     for (int i = 0; i < gang->num_members; i++) {
@@ -200,6 +324,7 @@ void plan_new_mission(Gang* gang, SimulationConfig config) {
     // Select a random target - make sure it's truly random by using NUM_CRIME_TYPES-1
     // NUM_CRIME_TYPES is the last entry in the enum, not a valid crime type
     gang->current_target = (CrimeType)random_int(0, NUM_CRIME_TYPES - 1);
+    gang->mission++;
     
     // Debug log to verify crime type assignment
     printf("Gang %d selected target crime: %s (enum value: %d)\n", 
@@ -215,13 +340,17 @@ void plan_new_mission(Gang* gang, SimulationConfig config) {
                 gang->id, crime_type_to_string(gang->current_target), 
                 gang->preparation_time, gang->required_preparation_level);
     
-    pthread_mutex_unlock(&gang->gang_mutex);
+    sim_mutex_unlock(&gang->gang_mutex);
+    pthread_rwlock_unlock(&gang->member_lock);
 }
 
 // Execute the mission
 void execute_mission(Gang* gang, SimulationConfig config) {
+    // Exclusive phase: members may die and be replaced
+    pthread_rwlock_wrlock(&gang->member_lock);
+    
     // Check if all members are prepared
-    pthread_mutex_lock(&gang->gang_mutex);
+    sim_mutex_lock(&gang->gang_mutex);
     
     int total_preparation = 0;
     int max_possible_prep = 0;
@@ -239,6 +368,7 @@ void execute_mission(Gang* gang, SimulationConfig config) {
     if (success_chance > 95) success_chance = 95; // Cap at 95%
     
     bool mission_success = random_event(success_chance);
+    bool investigate = false;
     
     log_message("Gang %d attempting to execute mission: %s (Avg prep: %d%%, Success chance: %d%%)", 
                 gang->id, crime_type_to_string(gang->current_target), 
@@ -270,168 +400,78 @@ void execute_mission(Gang* gang, SimulationConfig config) {
                     gang->id, crime_type_to_string(gang->current_target));
         
         // Investigate for secret agents if they fail too many times
-        if (gang->thwarted_missions % 2 == 0) {
-            investigate_for_agents(gang, config);
-        }
+        investigate = gang->thwarted_missions % 2 == 0;
     }
     
-    pthread_mutex_unlock(&gang->gang_mutex);
+    sim_mutex_unlock(&gang->gang_mutex);
+    pthread_rwlock_unlock(&gang->member_lock);
+    
+    // The investigation takes the gang mutex itself
+    if (investigate) {
+        investigate_for_agents(gang, config);
+    }
 }
 
 // Investigate for secret agents
 void investigate_for_agents(Gang* gang, SimulationConfig config) {
     log_message("Gang %d starting internal investigation", gang->id);
+    InvestigationScratch* scratch = &gang->investigation;
     
-    // Factors in investigation
-    typedef struct {
-        int member_id;
-        int suspicion_score;
-        bool is_agent;
-        int rank;
-        int prep_level;
-        int knowledge_rate;
-    } SuspiciousAgent;
-    
-    // First, copy member data with minimal mutex holding time
-    pthread_mutex_lock(&gang->gang_mutex);
+    // First, copy member data into the scratch columns with minimal mutex holding time
+    sim_mutex_lock(&gang->gang_mutex);
     int num_members = gang->num_members;
-    int num_ranks = gang->num_ranks;
-    int required_prep = gang->required_preparation_level;
     int gang_id = gang->id;
-    
-    // Create temporary copies of member data to avoid holding mutex during investigation
-    typedef struct {
-        int preparation_level;
-        int knowledge_rate;
-        int rank;
-        bool is_secret_agent;
-    } MemberSnapshot;
-    
-    MemberSnapshot* member_snapshots = (MemberSnapshot*)malloc(num_members * sizeof(MemberSnapshot));
-    if (member_snapshots == NULL) {
-        log_message("Gang %d: Failed to allocate memory for investigation", gang->id);
-        pthread_mutex_unlock(&gang->gang_mutex);
+    if (!investigation_begin(scratch, num_members)) {
+        log_message("Gang %d: Failed to allocate memory for investigation", gang_id);
+        sim_mutex_unlock(&gang->gang_mutex);
         return;
     }
     
-    // Copy member data quickly
+    scratch->count = num_members;
+    scratch->num_ranks = gang->num_ranks;
+    scratch->required_preparation = gang->required_preparation_level;
     for (int i = 0; i < num_members; i++) {
-        member_snapshots[i].preparation_level = gang->members[i].preparation_level;
-        member_snapshots[i].knowledge_rate = gang->members[i].knowledge_rate;
-        member_snapshots[i].rank = gang->members[i].rank;
-        member_snapshots[i].is_secret_agent = gang->members[i].is_secret_agent;
-    }
-    pthread_mutex_unlock(&gang->gang_mutex);
-    
-    // Now do the investigation work WITHOUT holding the mutex
-    SuspiciousAgent* suspects = (SuspiciousAgent*)malloc(num_members * sizeof(SuspiciousAgent));
-    if (suspects == NULL) {
-        log_message("Gang %d: Failed to allocate memory for suspects", gang_id);
-        free(member_snapshots);
-        return;
+        scratch->preparation[i] = gang->members[i].preparation_level;
+        scratch->knowledge_rate[i] = gang->members[i].knowledge_rate;
+        scratch->rank[i] = gang->members[i].rank;
+        scratch->is_agent[i] = gang->members[i].is_secret_agent;
     }
+    sim_mutex_unlock(&gang->gang_mutex);
     
+    // Now do the investigation work WITHOUT holding the mutex: score everyone
+    // and pick the most suspicious
     int num_suspects = 0;
-    
-    // First phase: Calculate suspicion scores based on multiple factors
-    for (int i = 0; i < num_members; i++) {
-        MemberSnapshot* member = &member_snapshots[i];
-        
-        // Base suspicion score
-        int suspicion_score = 0;
-        
-        // 1. Low preparation level may indicate lack of commitment
-        if (member->preparation_level < (required_prep / 2)) {
-            suspicion_score += 20;
-        }
-        
-        // 2. Newer members (lower ranks) are more suspicious
-        suspicion_score += (num_ranks - member->rank) * 5;
-        
-        // 3. Check for suspicious behavior patterns (could be expanded)
-        if (member->knowledge_rate > 80 && member->rank < 2) {
-            // Low-rank members shouldn't know too much
-            suspicion_score += 25;
-        }
-        
-        // If suspicion score is high enough, add to list of suspects
-        if (suspicion_score > 30) {
-            suspects[num_suspects].member_id = i;
-            suspects[num_suspects].suspicion_score = suspicion_score;
-            suspects[num_suspects].is_agent = member->is_secret_agent;
-            suspects[num_suspects].rank = member->rank;
-            suspects[num_suspects].prep_level = member->preparation_level;
-            suspects[num_suspects].knowledge_rate = member->knowledge_rate;
-            num_suspects++;
-        }
-    }
+    int num_interrogated = investigation_select(scratch, config.investigation_threshold,
+                                                config.investigation_top_k, &num_suspects);
     
     log_message("Gang %d identified %d suspicious members", gang_id, num_suspects);
     
-    // Second phase: Sort suspects by suspicion score (simple bubble sort)
-    for (int i = 0; i < num_suspects - 1; i++) {
-        for (int j = 0; j < num_suspects - i - 1; j++) {
-            if (suspects[j].suspicion_score < suspects[j + 1].suspicion_score) {
-                SuspiciousAgent temp = suspects[j];
-                suspects[j] = suspects[j + 1];
-                suspects[j + 1] = temp;
-            }
-        }
-    }
-    
     // Interrogate suspects (starting with most suspicious) - still no mutex needed
     int agents_found = 0;
-    typedef struct {
-        int member_id;
-        bool should_execute;
-        bool should_penalize;
-    } InvestigationResult;
-    
-    InvestigationResult* results = (InvestigationResult*)malloc(num_suspects * sizeof(InvestigationResult));
-    if (results == NULL) {
-        log_message("Gang %d: Failed to allocate memory for results", gang_id);
-        free(suspects);
-        free(member_snapshots);
-        return;
-    }
-    
-    int num_results = 0;
-    for (int i = 0; i < num_suspects && i < 3; i++) {  // Limit interrogations to top 3 suspects
-        int member_id = suspects[i].member_id;
-        
-        // Validate member_id to prevent array bounds issues
-        if (member_id < 0 || member_id >= num_members) {
-            log_message("Gang %d: Invalid member_id %d in investigation", gang_id, member_id);
-            continue;
-        }
-        
-        int rank = suspects[i].rank;
+    for (int i = 0; i < num_interrogated; i++) {
+        int member_id = scratch->order[i];
+        int rank = scratch->rank[member_id];
+        int suspicion_score = scratch->score[member_id];
+        scratch->verdict[i] = VERDICT_NONE;
         
         // Probability of uncovering agent depends on suspicion score and rank
-        int discovery_chance = 20 + (rank * 10) + (suspects[i].suspicion_score / 5);
+        int discovery_chance = 20 + (rank * 10) + (suspicion_score / 5);
         
         // Cap at 90%
         if (discovery_chance > 90) discovery_chance = 90;
         
-        if (suspects[i].is_agent && random_event(discovery_chance)) {
+        if (scratch->is_agent[member_id] && random_event(discovery_chance)) {
             log_message("Gang %d interrogated and uncovered secret agent %d (rank %d, suspicion: %d)", 
-                      gang_id, member_id, rank, suspects[i].suspicion_score);
-            
-            results[num_results].member_id = member_id;
-            results[num_results].should_execute = true;
-            results[num_results].should_penalize = false;
-            num_results++;
+                      gang_id, member_id, rank, suspicion_score);
+            scratch->verdict[i] = VERDICT_EXECUTE;
             agents_found++;
-        } else if (!suspects[i].is_agent) {
+        } else if (!scratch->is_agent[member_id]) {
             log_message("Gang %d interrogated innocent member %d (rank %d, suspicion: %d)", 
-                      gang_id, member_id, rank, suspects[i].suspicion_score);
+                      gang_id, member_id, rank, suspicion_score);
             
             // Penalty for wrongly accusing a member - they might become less loyal
             if (random_event(40)) {
-                results[num_results].member_id = member_id;
-                results[num_results].should_execute = false;
-                results[num_results].should_penalize = true;
-                num_results++;
+                scratch->verdict[i] = VERDICT_PENALIZE;
                 log_message("Member %d lost motivation due to false accusation", member_id);
             }
         }
@@ -440,63 +480,79 @@ void investigate_for_agents(Gang* gang, SimulationConfig config) {
     // Check for paranoia increase
     int actual_agents = 0;
     for (int i = 0; i < num_members; i++) {
-        if (member_snapshots[i].is_secret_agent) {
-            actual_agents++;
-        }
+        actual_agents += scratch->is_agent[i];
     }
     
     if (agents_found == 0 && actual_agents > 0) {
         log_message("Gang %d failed to find any agents, paranoia increasing", gang_id);
     }
     
-    // Now apply the results - lock mutex only briefly to update gang state
-    pthread_mutex_lock(&gang->gang_mutex);
-    for (int i = 0; i < num_results; i++) {
-        int member_id = results[i].member_id;
+    // Now apply the results - the only exclusive phase of an investigation
+    pthread_rwlock_wrlock(&gang->member_lock);
+    sim_mutex_lock(&gang->gang_mutex);
+    for (int i = 0; i < num_interrogated; i++) {
+        int member_id = scratch->order[i];
         
         // Double-check bounds again with current gang state
-        if (member_id >= 0 && member_id < gang->num_members) {
-            if (results[i].should_execute) {
-                // Execute the agent
-                gang->executed_agents++;
-                
-                // Replace the agent with a new member
-                gang->members[member_id].rank = 0;  // Lowest rank
-                gang->members[member_id].preparation_level = 0;
-                gang->members[member_id].knowledge_rate = 0;
-                gang->members[member_id].is_secret_agent = random_event(config.agent_infiltration_success_rate);
-            } else if (results[i].should_penalize) {
-                // Penalize innocent member
-                gang->members[member_id].preparation_level = (gang->members[member_id].preparation_level * 3) / 4;
-            }
+        if (member_id >= gang->num_members) continue;
+        
+        if (scratch->verdict[i] == VERDICT_EXECUTE) {
+            // Execute the agent
+            gang->executed_agents++;
+            
+            // Replace the agent with a new member
+            gang->members[member_id].rank = 0;  // Lowest rank
+            gang->members[member_id].preparation_level = 0;
+            gang->members[member_id].knowledge_rate = 0;
+            gang->members[member_id].is_secret_agent = random_event(config.agent_infiltration_success_rate);
+        } else if (scratch->verdict[i] == VERDICT_PENALIZE) {
+            // Penalize innocent member
+            gang->members[member_id].preparation_level = (gang->members[member_id].preparation_level * 3) / 4;
         }
     }
-    pthread_mutex_unlock(&gang->gang_mutex);
-    
-    // Free allocated memory
-    free(results);
-    free(suspects);
-    free(member_snapshots);
+    sim_mutex_unlock(&gang->gang_mutex);
+    pthread_rwlock_unlock(&gang->member_lock);
 }
 
 // Clean up gang resources
 void cleanup_gang(Gang* gang) {
-    // Set gang as inactive
+    // Set gang as inactive - a leader waiting out a prison term must wake up too
+    sim_mutex_lock(&gang->gang_mutex);
     gang->is_active = false;
     
     // Signal any waiting threads
     pthread_cond_broadcast(&gang->gang_cond);
+    sim_mutex_unlock(&gang->gang_mutex);
     
-    // Wait for all threads to finish
+    // The leader finishes its tick and releases the members one last time to exit
+    pthread_join(gang->leader_thread, NULL);
     for (int i = 0; i < gang->num_members; i++) {
         pthread_join(gang->members[i].thread, NULL);
     }
     
-    // Destroy mutex and condition variable
+    // Destroy locks, condition variable and barriers
     pthread_mutex_destroy(&gang->gang_mutex);
     pthread_cond_destroy(&gang->gang_cond);
+    pthread_barrier_destroy(&gang->tick_start);
+    pthread_barrier_destroy(&gang->tick_end);
+    pthread_rwlock_destroy(&gang->member_lock);
+    
+    // Mailboxes only overflow when a gang outgrows MAILBOX_MAX_CAPACITY
+    unsigned int tips_dropped = 0;
+    for (int i = 0; i < gang->num_members; i++) {
+        for (int j = 0; j < 2; j++) {
+            tips_dropped += atomic_load(&gang->members[i].inbox[j].dropped);
+            mailbox_destroy(&gang->members[i].inbox[j]);
+        }
+    }
+    if (tips_dropped > 0) {
+        log_message("Gang %d dropped %u tips to full mailboxes", gang->id, tips_dropped);
+    }
     
     // Free allocated memory
+    free(gang->member_views[0]);
+    free(gang->member_views[1]);
+    investigation_free(&gang->investigation);
     free(gang->members);
     
     log_message("Gang %d resources cleaned up", gang->id);
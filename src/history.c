@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/history.h"
+
+static const int level_seconds[HISTORY_LEVELS] = HISTORY_LEVEL_SECONDS;
+
+// Seconds covered by one bucket of `level`
+int history_level_seconds(int level) {
+    return level >= 0 && level < HISTORY_LEVELS ? level_seconds[level] : 0;
+}
+
+// Time covered by a whole ring of `level`, e.g. "30 min"
+void history_span_label(int level, char* label, size_t size) {
+    int span = history_level_seconds(level) * HISTORY_BUCKETS;
+    if (span >= 3600) {
+        snprintf(label, size, "%d h", span / 3600);
+    } else if (span >= 60) {
+        snprintf(label, size, "%d min", span / 60);
+    } else {
+        snprintf(label, size, "%d s", span);
+    }
+}
+
+// Fold one sample into a bucket
+static void bucket_add(HistoryBucket* bucket, int value) {
+    if (value > 32767) value = 32767;
+    if (value < -32768) value = -32768;
+
+    if (bucket->count == 0) {
+        bucket->min = value;
+        bucket->max = value;
+        bucket->sum = 0;
+    } else {
+        if (value < bucket->min) bucket->min = value;
+        if (value > bucket->max) bucket->max = value;
+    }
+    if (bucket->count < 65535) {
+        bucket->count++;
+        bucket->sum += value;
+    }
+}
+
+// Record one sample of every metric (only the owning gang process may call this)
+void history_record(GangHistory* history, const int values[HISTORY_METRICS], long long now_s) {
+    // Odd generation marks the history as being written
+    unsigned int generation = atomic_load_explicit(&history->generation, memory_order_relaxed);
+    atomic_store_explicit(&history->generation, generation + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (int level = 0; level < HISTORY_LEVELS; level++) {
+        long long bucket_number = now_s / level_seconds[level];
+
+        // Moving to a new bucket empties every bucket skipped on the way
+        if (generation == 0 || bucket_number != history->newest[level]) {
+            long long gap = generation == 0 ? HISTORY_BUCKETS : bucket_number - history->newest[level];
+            if (gap > HISTORY_BUCKETS || gap < 0) gap = HISTORY_BUCKETS;
+            for (long long b = bucket_number - gap + 1; b <= bucket_number; b++) {
+                int slot = (int)(b % HISTORY_BUCKETS);
+                for (int metric = 0; metric < HISTORY_METRICS; metric++) {
+                    history->buckets[level][metric][slot].count = 0;
+                }
+            }
+            history->newest[level] = bucket_number;
+        }
+
+        int slot = (int)(bucket_number % HISTORY_BUCKETS);
+        for (int metric = 0; metric < HISTORY_METRICS; metric++) {
+            bucket_add(&history->buckets[level][metric][slot], values[metric]);
+        }
+    }
+
+    atomic_store_explicit(&history->generation, generation + 2, memory_order_release);
+}
+
+// Copy one level of a history, oldest bucket first and the bucket holding `now_s`
+// last. Buckets the writer has not reached yet read as empty. Returns false if
+// nothing was recorded or no consistent copy could be taken.
+bool history_read(const GangHistory* history, int level, long long now_s,
+                  HistoryBucket out[HISTORY_METRICS][HISTORY_BUCKETS]) {
+    if (level < 0 || level >= HISTORY_LEVELS) return false;
+    GangHistory* source = (GangHistory*)history;
+    long long current = now_s / level_seconds[level];
+
+    for (int attempt = 0; attempt < 100; attempt++) {
+        unsigned int before = atomic_load_explicit(&source->generation, memory_order_acquire);
+        if (before == 0) return false;      // Never recorded
+        if (before & 1) continue;           // Writer in progress
+
+        long long newest = source->newest[level];
+        for (int i = 0; i < HISTORY_BUCKETS; i++) {
+            long long b = current - (HISTORY_BUCKETS - 1) + i;
+            for (int metric = 0; metric < HISTORY_METRICS; metric++) {
+                if (b < 0 || b > newest || b <= newest - HISTORY_BUCKETS) {
+                    memset(&out[metric][i], 0, sizeof(HistoryBucket));
+                } else {
+                    out[metric][i] = source->buckets[level][metric][b % HISTORY_BUCKETS];
+                }
+            }
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&source->generation, memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+// Current generation of a history, 0 if nothing was recorded
+unsigned int history_generation(const GangHistory* history) {
+    return atomic_load_explicit((atomic_uint*)&history->generation, memory_order_acquire);
+}
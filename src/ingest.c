@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/ingest.h"
+#include "../include/visualization.h"
+#include "../include/metrics.h"
+#include "../include/utils.h"
+#include "../include/lock_profile.h"
+
+// State version the last snapshot was published for (ingesting thread only)
+static unsigned int published_version = 0;
+static bool published_once = false;
+
+// Ingestion thread, cleared by ingest_stop()
+static pthread_t ingest_pthread;
+static bool ingest_started = false;
+static atomic_bool ingest_running = false;
+
+// Fold one gang's shared-memory state into its visualization state;
+// returns true if anything visible changed
+static bool ingest_gang(const SharedState* shared_state, int gang_id, GangVisState* gang_state) {
+    bool changed = false;
+
+    bool is_arrested = shared_state->gang_status[gang_id].is_arrested;
+    int prison_time = shared_state->gang_status[gang_id].prison_time;
+    if (gang_state->is_in_prison != is_arrested || gang_state->prison_time_remaining != prison_time) {
+        gang_state->is_in_prison = is_arrested;
+        gang_state->prison_time_remaining = prison_time;
+        changed = true;
+    }
+
+    // Gangs that have not published yet keep their initial state
+    GangVisRecord record;
+    if (read_gang_record(shared_state, gang_id, &record) &&
+        (gang_state->preparation_level != record.preparation_level ||
+         gang_state->current_target != record.current_target ||
+         gang_state->num_members != record.num_members ||
+         gang_state->num_agents != record.num_agents ||
+         gang_state->is_active != record.is_active)) {
+        gang_state->preparation_level = record.preparation_level;
+        gang_state->current_target = record.current_target;
+        gang_state->num_members = record.num_members;
+        gang_state->num_agents = record.num_agents;
+        gang_state->is_active = record.is_active;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// One ingestion pass over every gang, publishing a snapshot if anything changed.
+// The ingesting thread owns viz_context.gang_states; the renderers only read
+// published snapshots. Returns true if a snapshot was published.
+bool ingest_tick() {
+    SharedState* shared_state = viz_context.shared_state;
+    if (shared_state == NULL || viz_context.gang_states == NULL) return false;
+
+    long long start = monotonic_time_us();
+    unsigned int version = atomic_load_explicit(&shared_state->state_version, memory_order_acquire);
+
+    int num_gangs = viz_context.num_gangs;
+    if (num_gangs > MAX_SHARED_GANGS) num_gangs = MAX_SHARED_GANGS;
+
+    bool changed = !published_once;
+    for (int i = 0; i < num_gangs; i++) {
+        if (ingest_gang(shared_state, i, &viz_context.gang_states[i])) {
+            changed = true;
+        }
+    }
+
+    bool publish = changed || version != published_version || visualization_details_changed();
+    if (publish) {
+        published_version = version;
+        published_once = true;
+        visualization_publish_snapshot();
+    }
+
+    if (metrics_registry != NULL) {
+        metrics_observe_us(&metrics_registry->ingest_tick, monotonic_time_us() - start);
+        if (publish) METRICS_INC(snapshots_published);
+    }
+    return publish;
+}
+
+// Ingestion loop - runs until ingest_stop()
+static void* ingest_thread(void* arg) {
+    while (atomic_load(&ingest_running)) {
+        ingest_tick();
+        usleep(INGEST_INTERVAL_MS * 1000);
+    }
+    return NULL;
+}
+
+// Start ingesting in a background thread
+bool ingest_start() {
+    if (ingest_started) return true;
+
+    atomic_store(&ingest_running, true);
+    if (pthread_create(&ingest_pthread, NULL, ingest_thread, NULL) != 0) {
+        perror("Failed to create ingestion thread");
+        atomic_store(&ingest_running, false);
+        return false;
+    }
+    ingest_started = true;
+    return true;
+}
+
+// Stop the ingestion thread and wait for it, so shared memory and the snapshot
+// buffers can be released afterwards
+void ingest_stop() {
+    if (!ingest_started) return;
+    ingest_started = false;
+    atomic_store(&ingest_running, false);
+
+    // Stopping from the ingestion thread itself (a signal landed on it) cannot wait for it
+    if (!pthread_equal(pthread_self(), ingest_pthread)) {
+        pthread_join(ingest_pthread, NULL);
+    }
+}
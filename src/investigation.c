@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/investigation.h"
+
+// A scoring feature adds weight * feature(member) to every member's score.
+// Features work on whole columns without branching so the loops vectorize.
+typedef void (*ScoringFeature)(const InvestigationScratch* scratch, int weight, int* score);
+
+typedef struct {
+    const char* name;
+    ScoringFeature apply;
+    int weight;                 // Set by investigation_configure
+} ScoringRule;
+
+// Preparation below half the required level
+static void feature_low_preparation(const InvestigationScratch* scratch, int weight, int* score) {
+    const int* preparation = scratch->preparation;
+    int half_required = scratch->required_preparation / 2;
+    for (int i = 0; i < scratch->count; i++) {
+        score[i] += weight * (preparation[i] < half_required);
+    }
+}
+
+// Distance from the top rank
+static void feature_low_rank(const InvestigationScratch* scratch, int weight, int* score) {
+    const int* rank = scratch->rank;
+    int num_ranks = scratch->num_ranks;
+    for (int i = 0; i < scratch->count; i++) {
+        score[i] += weight * (num_ranks - rank[i]);
+    }
+}
+
+// Low-ranked members who know suspiciously much
+static void feature_knows_too_much(const InvestigationScratch* scratch, int weight, int* score) {
+    const int* rank = scratch->rank;
+    const int* knowledge_rate = scratch->knowledge_rate;
+    for (int i = 0; i < scratch->count; i++) {
+        score[i] += weight * ((knowledge_rate[i] > 80) & (rank[i] < 2));
+    }
+}
+
+// The knowledge rate itself
+static void feature_knowledge(const InvestigationScratch* scratch, int weight, int* score) {
+    const int* knowledge_rate = scratch->knowledge_rate;
+    for (int i = 0; i < scratch->count; i++) {
+        score[i] += weight * knowledge_rate[i];
+    }
+}
+
+// Registry of scoring features; weights default to DEFAULT_INVESTIGATION_SCORING
+static ScoringRule scoring_rules[] = {
+    {"low_preparation", feature_low_preparation, 20},
+    {"low_rank", feature_low_rank, 5},
+    {"knows_too_much", feature_knows_too_much, 25},
+    {"knowledge", feature_knowledge, 0},
+};
+
+#define NUM_SCORING_RULES ((int)(sizeof(scoring_rules) / sizeof(scoring_rules[0])))
+
+// Set the feature weights from a "name:weight,..." list; false (weights unchanged) if malformed
+bool investigation_configure(const char* scoring) {
+    int weights[NUM_SCORING_RULES] = {0};
+
+    const char* p = scoring;
+    while (*p) {
+        const char* colon = strchr(p, ':');
+        if (colon == NULL) break;
+
+        int rule = -1;
+        for (int r = 0; r < NUM_SCORING_RULES; r++) {
+            size_t length = strlen(scoring_rules[r].name);
+            if ((size_t)(colon - p) == length && strncmp(p, scoring_rules[r].name, length) == 0) {
+                rule = r;
+                break;
+            }
+        }
+        if (rule < 0) {
+            fprintf(stderr, "Unknown investigation scoring feature '%.*s'\n", (int)(colon - p), p);
+            return false;
+        }
+
+        char* end;
+        long weight = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || (*end != ',' && *end != '\0')) break;
+        weights[rule] = (int)weight;
+
+        p = end;
+        if (*p == ',') p++;
+    }
+
+    if (*p != '\0') {
+        fprintf(stderr, "Invalid INVESTIGATION_SCORING '%s' (expected name:weight,...)\n", scoring);
+        return false;
+    }
+
+    for (int r = 0; r < NUM_SCORING_RULES; r++) {
+        scoring_rules[r].weight = weights[r];
+    }
+    return true;
+}
+
+// Arena bytes one investigation of `members` needs
+static size_t investigation_size(int members) {
+    // Five int columns and two byte columns, each rounded up by the arena
+    return 5 * ((size_t)members * sizeof(int) + 16) + 2 * ((size_t)members + 16);
+}
+
+// Set up a gang's scratch with room for an investigation of `members`
+bool investigation_init(InvestigationScratch* scratch, int members) {
+    memset(scratch, 0, sizeof(*scratch));
+    return arena_init(&scratch->arena, investigation_size(members));
+}
+
+// Carve the columns of a new investigation of `members` out of the arena,
+// releasing the previous investigation's
+bool investigation_begin(InvestigationScratch* scratch, int members) {
+    Arena* arena = &scratch->arena;
+    arena_reset(arena);
+
+    scratch->preparation = (int*)arena_alloc(arena, (size_t)members * sizeof(int));
+    scratch->knowledge_rate = (int*)arena_alloc(arena, (size_t)members * sizeof(int));
+    scratch->rank = (int*)arena_alloc(arena, (size_t)members * sizeof(int));
+    scratch->score = (int*)arena_alloc(arena, (size_t)members * sizeof(int));
+    scratch->order = (int*)arena_alloc(arena, (size_t)members * sizeof(int));
+    scratch->is_agent = (unsigned char*)arena_alloc(arena, (size_t)members);
+    scratch->verdict = (unsigned char*)arena_alloc(arena, (size_t)members);
+
+    return scratch->preparation != NULL && scratch->knowledge_rate != NULL && scratch->rank != NULL &&
+           scratch->score != NULL && scratch->order != NULL && scratch->is_agent != NULL &&
+           scratch->verdict != NULL;
+}
+
+// Release a scratch area
+void investigation_free(InvestigationScratch* scratch) {
+    arena_destroy(&scratch->arena);
+    memset(scratch, 0, sizeof(*scratch));
+}
+
+// Whether member a ranks ahead of member b (higher score, then lower id)
+static inline bool ranks_ahead(const int* score, int a, int b) {
+    return score[a] > score[b] || (score[a] == score[b] && a < b);
+}
+
+// Partially order ids[0..n) so its first k entries are the k best members
+static void select_top(int* ids, int n, int k, const int* score) {
+    int left = 0;
+    int right = n - 1;
+    while (left < right) {
+        // Median of three as pivot
+        int middle = left + (right - left) / 2;
+        int a = ids[left], b = ids[middle], c = ids[right];
+        int pivot;
+        if (ranks_ahead(score, a, b)) {
+            pivot = ranks_ahead(score, b, c) ? b : (ranks_ahead(score, a, c) ? c : a);
+        }
+        else {
+            pivot = ranks_ahead(score, a, c) ? a : (ranks_ahead(score, b, c) ? c : b);
+        }
+
+        // Hoare partition: members ahead of the pivot to the left
+        int i = left, j = right;
+        while (i <= j) {
+            while (ranks_ahead(score, ids[i], pivot)) i++;
+            while (ranks_ahead(score, pivot, ids[j])) j--;
+            if (i <= j) {
+                int tmp = ids[i];
+                ids[i] = ids[j];
+                ids[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+
+        if (k - 1 <= j) right = j;
+        else if (k - 1 >= i) left = i;
+        else break;
+    }
+}
+
+// Score the copied members and put the top_k of those scoring above the
+// threshold into scratch->order, most suspicious first. Returns how many were
+// selected; num_suspects gets how many scored above the threshold at all.
+int investigation_select(InvestigationScratch* scratch, int threshold, int top_k, int* num_suspects) {
+    int count = scratch->count;
+    int* score = scratch->score;
+
+    memset(score, 0, (size_t)count * sizeof(int));
+    for (int r = 0; r < NUM_SCORING_RULES; r++) {
+        if (scoring_rules[r].weight != 0) {
+            scoring_rules[r].apply(scratch, scoring_rules[r].weight, score);
+        }
+    }
+
+    // Suspects
+    int* order = scratch->order;
+    int suspects = 0;
+    for (int i = 0; i < count; i++) {
+        order[suspects] = i;
+        suspects += score[i] > threshold;
+    }
+    *num_suspects = suspects;
+
+    int selected = suspects < top_k ? suspects : top_k;
+    if (selected <= 0) return 0;
+    if (selected < suspects) {
+        select_top(order, suspects, selected, score);
+    }
+
+    // Only the selected few get sorted
+    for (int i = 1; i < selected; i++) {
+        int id = order[i];
+        int j = i - 1;
+        while (j >= 0 && ranks_ahead(score, id, order[j])) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = id;
+    }
+    return selected;
+}
@@ -7,8 +7,11 @@
 #include <sys/shm.h>
 #include <sys/sem.h>
 #include <errno.h>
+#include <pthread.h>
+#include <time.h>
 #include "../include/ipc.h"
 #include "../include/utils.h"
+#include "../include/metrics.h"
 
 // Define keys for IPC resources
 #define REPORT_QUEUE_KEY 0x1234
@@ -21,21 +24,98 @@
 // Number of semaphores in the set
 #define NUM_SEMAPHORES 1
 
-// Create message queue for intelligence reports
-int create_report_queue() {
-    int queue_id = msgget(REPORT_QUEUE_KEY, IPC_CREAT | 0666);
+// Run id selecting this simulation's IPC keys (crime_sim/crime_view --run-id)
+int ipc_run_id = 0;
+
+// Hosting mode selected by crime_sim --mode
+IpcMode ipc_mode = IPC_MODE_PROCESSES;
+
+// Id handed out for the first in-memory channel, so callers checking for a valid
+// id keep working. Partition p gets IN_PROCESS_ID + p.
+#define IN_PROCESS_ID 1
+
+// Reports each lane of the in-memory queue holds before sends fail with EAGAIN, like a full message queue
+#define REPORT_CHANNEL_CAPACITY 1024
+
+// How long an in-memory receive waits for a report before reporting ENOMSG
+#define REPORT_CHANNEL_WAIT_MS 10
+
+// Payload of a report message (everything after mtype)
+#define REPORT_MESSAGE_SIZE (sizeof(ReportMessage) - sizeof(long))
+
+// Suspicion that makes a report urgent, set from the config by crime_sim
+int report_lane_threshold = 80;
+
+// Report queue partitions, set from the config by crime_sim
+int report_partitions = 1;
+int report_partition_gangs = 1;
+
+// In-memory report queue partition used in IPC_MODE_THREADS, one ring per lane
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    ReportMessage messages[NUM_REPORT_LANES][REPORT_CHANNEL_CAPACITY];
+    int head[NUM_REPORT_LANES];
+    int count[NUM_REPORT_LANES];
+    int total;
+    bool closed;
+} ReportChannel;
+
+static ReportChannel report_channels[MAX_REPORT_PARTITIONS];
+
+// Reports in all in-memory partitions together, for the queue depth metric
+static atomic_int report_channel_depth;
+
+// In-memory binary semaphore used in IPC_MODE_THREADS
+static pthread_mutex_t state_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Create the message queue of one report queue partition
+int create_report_queue(int partition) {
+    if (ipc_mode == IPC_MODE_THREADS) {
+        ReportChannel* channel = &report_channels[partition];
+        pthread_mutex_init(&channel->mutex, NULL);
+        pthread_cond_init(&channel->not_empty, NULL);
+        for (int lane = 0; lane < NUM_REPORT_LANES; lane++) {
+            channel->head[lane] = 0;
+            channel->count[lane] = 0;
+        }
+        channel->total = 0;
+        channel->closed = false;
+        
+        log_message("Created in-memory report queue partition %d", partition);
+        return IN_PROCESS_ID + partition;
+    }
+    
+    int queue_id = msgget(RUN_KEY(REPORT_QUEUE_KEY) + partition, IPC_CREAT | 0666);
     
     if (queue_id == -1) {
         perror("Failed to create message queue");
         exit(1);
     }
     
-    log_message("Created message queue with ID %d", queue_id);
+    log_message("Created message queue with ID %d for report partition %d", queue_id, partition);
     return queue_id;
 }
 
 // Destroy message queue
 void destroy_report_queue(int queue_id) {
+    if (ipc_mode == IPC_MODE_THREADS) {
+        // Later sends fail like they would on a removed message queue
+        ReportChannel* channel = &report_channels[queue_id - IN_PROCESS_ID];
+        pthread_mutex_lock(&channel->mutex);
+        channel->closed = true;
+        for (int lane = 0; lane < NUM_REPORT_LANES; lane++) {
+            channel->count[lane] = 0;
+        }
+        atomic_fetch_sub(&report_channel_depth, channel->total);
+        channel->total = 0;
+        pthread_cond_broadcast(&channel->not_empty);
+        pthread_mutex_unlock(&channel->mutex);
+        
+        log_message("Destroyed in-memory report queue partition %d", queue_id - IN_PROCESS_ID);
+        return;
+    }
+    
     if (msgctl(queue_id, IPC_RMID, NULL) == -1) {
         perror("Failed to destroy message queue");
     }
@@ -44,34 +124,144 @@ void destroy_report_queue(int queue_id) {
     }
 }
 
-// Send an intelligence report
+// Append a message to its lane of an in-memory partition; -1 with errno EAGAIN while the lane is full
+static int channel_send(ReportChannel* channel, const ReportMessage* msg) {
+    int lane = msg->mtype - 1;
+    
+    pthread_mutex_lock(&channel->mutex);
+    if (channel->closed) {
+        pthread_mutex_unlock(&channel->mutex);
+        errno = EIDRM;
+        return -1;
+    }
+    if (channel->count[lane] == REPORT_CHANNEL_CAPACITY) {
+        pthread_mutex_unlock(&channel->mutex);
+        errno = EAGAIN;
+        return -1;
+    }
+    
+    int tail = (channel->head[lane] + channel->count[lane]) % REPORT_CHANNEL_CAPACITY;
+    channel->messages[lane][tail] = *msg;
+    channel->count[lane]++;
+    channel->total++;
+    METRICS_SET(report_queue_depth, atomic_fetch_add(&report_channel_depth, 1) + 1);
+    
+    pthread_cond_signal(&channel->not_empty);
+    pthread_mutex_unlock(&channel->mutex);
+    return 0;
+}
+
+// Take the oldest message of the most urgent non-empty lane. Waits up to
+// REPORT_CHANNEL_WAIT_MS, so a polling receiver does not spin on an empty queue.
+// Returns the payload size like msgrcv, or -1 with errno ENOMSG.
+static int channel_receive(ReportChannel* channel, ReportMessage* msg) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += REPORT_CHANNEL_WAIT_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&channel->mutex);
+    while (channel->total == 0 && !channel->closed) {
+        if (pthread_cond_timedwait(&channel->not_empty, &channel->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (channel->total == 0) {
+        pthread_mutex_unlock(&channel->mutex);
+        errno = ENOMSG;
+        return -1;
+    }
+    
+    int lane = 0;
+    while (channel->count[lane] == 0) {
+        lane++;
+    }
+    *msg = channel->messages[lane][channel->head[lane]];
+    channel->head[lane] = (channel->head[lane] + 1) % REPORT_CHANNEL_CAPACITY;
+    channel->count[lane]--;
+    channel->total--;
+    METRICS_SET(report_queue_depth, atomic_fetch_sub(&report_channel_depth, 1) - 1);
+    
+    pthread_mutex_unlock(&channel->mutex);
+    return REPORT_MESSAGE_SIZE;
+}
+
+// Report queue partition carrying the reports about a gang
+int report_partition(int gang_id) {
+    int partition = gang_id * report_partitions / report_partition_gangs;
+    if (partition < 0) return 0;
+    if (partition >= report_partitions) return report_partitions - 1;
+    return partition;
+}
+
+// Priority lane of a report, from the crime reported and the suspicion
+ReportLane report_lane(IntelligenceReport report) {
+    bool high_risk = crime_is_high_risk(report.suspected_target);
+    bool suspicious = report.suspicion_level >= report_lane_threshold;
+    
+    if (high_risk && suspicious) return REPORT_LANE_URGENT;
+    if (high_risk || suspicious) return REPORT_LANE_PRIORITY;
+    return REPORT_LANE_ROUTINE;
+}
+
+// Send an intelligence report on its lane without waiting. A full queue fails
+// with errno EAGAIN and the caller may retry; any other failure loses the report.
 int send_report(int queue_id, IntelligenceReport report) {
     ReportMessage msg;
-    msg.mtype = 1;  // Message type (can be used for filtering)
+    msg.mtype = report_lane(report);
     msg.report = report;
+    msg.sent_us = monotonic_time_us();
     
-    int result = msgsnd(queue_id, &msg, sizeof(IntelligenceReport), 0);
+    int result;
+    if (ipc_mode == IPC_MODE_THREADS) {
+        result = channel_send(&report_channels[queue_id - IN_PROCESS_ID], &msg);
+    }
+    else {
+        result = msgsnd(queue_id, &msg, REPORT_MESSAGE_SIZE, IPC_NOWAIT);
+        if (result == -1 && errno != EAGAIN) {
+            perror("Failed to send report");
+        }
+    }
     
     if (result == -1) {
-        perror("Failed to send report");
+        if (errno != EAGAIN) {
+            METRICS_INC(reports_failed);
+        }
+    }
+    else {
+        METRICS_INC(reports_sent);
     }
     
     return result;
 }
 
-// Receive an intelligence report
-int receive_report(int queue_id, IntelligenceReport* report) {
+// Receive an intelligence report, most urgent lane first. sent_us, if not
+// NULL, gets the time it was sent.
+int receive_report(int queue_id, IntelligenceReport* report, long long* sent_us) {
     ReportMessage msg;
     
-    int result = msgrcv(queue_id, &msg, sizeof(IntelligenceReport), 0, IPC_NOWAIT);
-    
-    if (result == -1) {
-        if (errno != ENOMSG) {
+    int result;
+    if (ipc_mode == IPC_MODE_THREADS) {
+        result = channel_receive(&report_channels[queue_id - IN_PROCESS_ID], &msg);
+    }
+    else {
+        // A negative type takes the lowest message type, i.e. the most urgent lane
+        result = msgrcv(queue_id, &msg, REPORT_MESSAGE_SIZE, -NUM_REPORT_LANES, IPC_NOWAIT);
+        if (result == -1 && errno != ENOMSG) {
             perror("Failed to receive report");
         }
     }
-    else {
+    
+    if (result != -1) {
         *report = msg.report;
+        if (sent_us != NULL) {
+            *sent_us = msg.sent_us;
+        }
+        METRICS_INC(reports_received);
+        metrics_observe_report_latency(msg.mtype, monotonic_time_us() - msg.sent_us);
     }
     
     return result;
@@ -79,7 +269,7 @@ int receive_report(int queue_id, IntelligenceReport* report) {
 
 // Create shared memory segment
 int create_shared_memory() {
-    int shm_id = shmget(SHARED_MEMORY_KEY, SHARED_MEMORY_SIZE, IPC_CREAT | 0666);
+    int shm_id = shmget(RUN_KEY(SHARED_MEMORY_KEY), SHARED_MEMORY_SIZE, IPC_CREAT | 0666);
     
     if (shm_id == -1) {
         perror("Failed to create shared memory");
@@ -112,6 +302,18 @@ SharedState* attach_shared_memory(int shm_id) {
     return shm_ptr;
 }
 
+// Attach to shared memory without write access (viewers)
+SharedState* attach_shared_memory_readonly(int shm_id) {
+    SharedState* shm_ptr = (SharedState*)shmat(shm_id, NULL, SHM_RDONLY);
+    
+    if (shm_ptr == (SharedState*)-1) {
+        perror("Failed to attach to shared memory");
+        return NULL;
+    }
+    
+    return shm_ptr;
+}
+
 // Detach from shared memory
 void detach_shared_memory(SharedState* shm_ptr) {
     if (shmdt(shm_ptr) == -1) {
@@ -119,9 +321,108 @@ void detach_shared_memory(SharedState* shm_ptr) {
     }
 }
 
+// Tell viewers that the shared state changed
+void publish_state_change(SharedState* shm_ptr) {
+    atomic_fetch_add_explicit(&shm_ptr->state_version, 1, memory_order_release);
+}
+
+// Write a gang's dashboard record (only its own gang process writes it)
+void publish_gang_record(SharedState* shm_ptr, int gang_id, const GangVisRecord* record) {
+    if (gang_id < 0 || gang_id >= MAX_SHARED_GANGS) return;
+    GangVisRecord* slot = &shm_ptr->gang_vis[gang_id];
+    
+    // Odd sequence marks the record as being written
+    unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    
+    slot->preparation_level = record->preparation_level;
+    slot->current_target = record->current_target;
+    slot->num_members = record->num_members;
+    slot->num_agents = record->num_agents;
+    slot->is_active = record->is_active;
+    
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+}
+
+// Copy a consistent version of a gang's dashboard record; false if none was published
+bool read_gang_record(const SharedState* shm_ptr, int gang_id, GangVisRecord* record) {
+    if (gang_id < 0 || gang_id >= MAX_SHARED_GANGS) return false;
+    GangVisRecord* slot = (GangVisRecord*)&shm_ptr->gang_vis[gang_id];
+    
+    for (int attempt = 0; attempt < 100; attempt++) {
+        unsigned int before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before == 0) return false;      // Never published
+        if (before & 1) continue;           // Writer in progress
+        
+        record->preparation_level = slot->preparation_level;
+        record->current_target = slot->current_target;
+        record->num_members = slot->num_members;
+        record->num_agents = slot->num_agents;
+        record->is_active = slot->is_active;
+        
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+// Rewrite a gang's member table (only its own gang process writes it)
+void publish_member_table(SharedState* shm_ptr, int gang_id, const GangMemberRecord* members, int num_members) {
+    if (gang_id < 0 || gang_id >= MAX_SHARED_GANGS) return;
+    GangMemberTable* table = &shm_ptr->member_tables[gang_id];
+    if (num_members > MAX_SHARED_MEMBERS) num_members = MAX_SHARED_MEMBERS;
+    
+    // Odd generation marks the table as being written
+    unsigned int generation = atomic_load_explicit(&table->generation, memory_order_relaxed);
+    atomic_store_explicit(&table->generation, generation + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    
+    table->num_members = num_members;
+    memcpy(table->members, members, num_members * sizeof(GangMemberRecord));
+    
+    atomic_store_explicit(&table->generation, generation + 2, memory_order_release);
+}
+
+// Current generation of a gang's member table, 0 if it was never published
+unsigned int member_table_generation(const SharedState* shm_ptr, int gang_id) {
+    if (gang_id < 0 || gang_id >= MAX_SHARED_GANGS) return 0;
+    return atomic_load_explicit((atomic_uint*)&shm_ptr->member_tables[gang_id].generation, memory_order_acquire);
+}
+
+// Copy a gang's member table into `members` (room for MAX_SHARED_MEMBERS).
+// Returns the generation copied, or 0 if no consistent copy could be taken.
+unsigned int read_member_table(const SharedState* shm_ptr, int gang_id, GangMemberRecord* members, int* num_members) {
+    if (gang_id < 0 || gang_id >= MAX_SHARED_GANGS) return 0;
+    GangMemberTable* table = (GangMemberTable*)&shm_ptr->member_tables[gang_id];
+    
+    for (int attempt = 0; attempt < 100; attempt++) {
+        unsigned int before = atomic_load_explicit(&table->generation, memory_order_acquire);
+        if (before == 0) return 0;          // Never published
+        if (before & 1) continue;           // Writer in progress
+        
+        int count = table->num_members;
+        if (count < 0) count = 0;
+        if (count > MAX_SHARED_MEMBERS) count = MAX_SHARED_MEMBERS;
+        memcpy(members, table->members, count * sizeof(GangMemberRecord));
+        
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&table->generation, memory_order_relaxed) == before) {
+            *num_members = count;
+            return before;
+        }
+    }
+    return 0;
+}
+
 // Create semaphore set
 int create_semaphore_set() {
-    int sem_id = semget(SEMAPHORE_KEY, NUM_SEMAPHORES, IPC_CREAT | 0666);
+    if (ipc_mode == IPC_MODE_THREADS) {
+        log_message("Created in-memory state lock");
+        return IN_PROCESS_ID;
+    }
+    
+    int sem_id = semget(RUN_KEY(SEMAPHORE_KEY), NUM_SEMAPHORES, IPC_CREAT | 0666);
     
     if (sem_id == -1) {
         perror("Failed to create semaphore set");
@@ -146,8 +447,22 @@ int create_semaphore_set() {
     return sem_id;
 }
 
+// Find the semaphore set created by the coordinator, -1 if there is none
+int open_semaphore_set() {
+    if (ipc_mode == IPC_MODE_THREADS) {
+        return IN_PROCESS_ID;
+    }
+    
+    return semget(RUN_KEY(SEMAPHORE_KEY), 0, 0);
+}
+
 // Destroy semaphore set
 void destroy_semaphore_set(int sem_id) {
+    if (ipc_mode == IPC_MODE_THREADS) {
+        // Statically initialized - threads still holding it at exit must not see it destroyed
+        return;
+    }
+    
     if (semctl(sem_id, 0, IPC_RMID) == -1) {
         perror("Failed to destroy semaphore set");
     }
@@ -158,6 +473,11 @@ void destroy_semaphore_set(int sem_id) {
 
 // Wait on semaphore (P operation)
 void semaphore_wait(int sem_id, int sem_num) {
+    if (ipc_mode == IPC_MODE_THREADS) {
+        pthread_mutex_lock(&state_lock);
+        return;
+    }
+    
     struct sembuf sb;
     sb.sem_num = sem_num;
     sb.sem_op = -1;
@@ -170,6 +490,11 @@ void semaphore_wait(int sem_id, int sem_num) {
 
 // Signal semaphore (V operation)
 void semaphore_signal(int sem_id, int sem_num) {
+    if (ipc_mode == IPC_MODE_THREADS) {
+        pthread_mutex_unlock(&state_lock);
+        return;
+    }
+    
     struct sembuf sb;
     sb.sem_num = sem_num;
     sb.sem_op = 1;
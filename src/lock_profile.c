@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/lock_profile.h"
+#include "../include/utils.h"
+
+#ifdef LOCK_PROFILE
+
+// Table sizes
+#define MAX_PROFILED_LOCKS 64
+#define MAX_CALL_SITES 16
+#define PROFILE_BUCKETS 24   // log2 microsecond buckets: <1us, <2us, <4us, ...
+
+// Statistics for one call site of a lock
+typedef struct {
+    const char* file;
+    int line;
+    unsigned long acquisitions;
+    unsigned long contended;
+    long long total_wait_us;
+} CallSite;
+
+// Statistics for one lock. Everything except `mutex` is only written while
+// the profiled lock itself is held, so the lock serializes its own statistics.
+typedef struct {
+    _Atomic(pthread_mutex_t*) mutex;
+    const char* name;
+    unsigned long acquisitions;
+    unsigned long contended;
+    long long total_wait_us;
+    long long max_wait_us;
+    long long total_hold_us;
+    long long max_hold_us;
+    unsigned long wait_histogram[PROFILE_BUCKETS];
+    unsigned long hold_histogram[PROFILE_BUCKETS];
+    long long hold_start_us;
+    CallSite sites[MAX_CALL_SITES];
+    int num_sites;
+} LockStats;
+
+static LockStats lock_table[MAX_PROFILED_LOCKS];
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t profile_once = PTHREAD_ONCE_INIT;
+
+// A forked child starts with a clean profile of its own
+static void reset_after_fork() {
+    memset(lock_table, 0, sizeof(lock_table));
+    pthread_mutex_init(&registry_mutex, NULL);
+}
+
+static void install_profile_hooks() {
+    pthread_atfork(NULL, NULL, reset_after_fork);
+    atexit(lock_profile_report);
+}
+
+// Histogram bucket for a duration in microseconds
+static int duration_bucket(long long us) {
+    if (us <= 0) return 0;
+    int bucket = 64 - __builtin_clzll((unsigned long long)us);
+    return bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1;
+}
+
+// Find (or register) the statistics entry of a mutex
+static LockStats* lookup_lock(pthread_mutex_t* mutex, const char* name) {
+    unsigned int start = (unsigned int)(((uintptr_t)mutex >> 4) % MAX_PROFILED_LOCKS);
+
+    // Lock-free lookup for already registered locks
+    for (int i = 0; i < MAX_PROFILED_LOCKS; i++) {
+        LockStats* stats = &lock_table[(start + i) % MAX_PROFILED_LOCKS];
+        pthread_mutex_t* owner = atomic_load_explicit(&stats->mutex, memory_order_acquire);
+        if (owner == mutex) return stats;
+        if (owner == NULL) break;
+    }
+
+    // First use of this lock - register it
+    pthread_once(&profile_once, install_profile_hooks);
+    pthread_mutex_lock(&registry_mutex);
+    LockStats* found = NULL;
+    for (int i = 0; i < MAX_PROFILED_LOCKS && found == NULL; i++) {
+        LockStats* stats = &lock_table[(start + i) % MAX_PROFILED_LOCKS];
+        pthread_mutex_t* owner = atomic_load_explicit(&stats->mutex, memory_order_relaxed);
+        if (owner == mutex) {
+            found = stats;
+        }
+        else if (owner == NULL) {
+            stats->name = (name[0] == '&') ? name + 1 : name;
+            atomic_store_explicit(&stats->mutex, mutex, memory_order_release);
+            found = stats;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    return found;
+}
+
+// Record a completed acquisition (called with the lock held)
+static void record_acquisition(LockStats* stats, const char* file, int line, long long wait_us, int contended) {
+    stats->acquisitions++;
+    stats->contended += contended;
+    stats->total_wait_us += wait_us;
+    if (wait_us > stats->max_wait_us) stats->max_wait_us = wait_us;
+    stats->wait_histogram[duration_bucket(wait_us)]++;
+    stats->hold_start_us = monotonic_time_us();
+
+    // Attribute the wait to its call site
+    CallSite* site = NULL;
+    for (int i = 0; i < stats->num_sites; i++) {
+        if (stats->sites[i].line == line && strcmp(stats->sites[i].file, file) == 0) {
+            site = &stats->sites[i];
+            break;
+        }
+    }
+    if (site == NULL && stats->num_sites < MAX_CALL_SITES) {
+        site = &stats->sites[stats->num_sites++];
+        site->file = file;
+        site->line = line;
+    }
+    if (site != NULL) {
+        site->acquisitions++;
+        site->contended += contended;
+        site->total_wait_us += wait_us;
+    }
+}
+
+// Record the end of a hold (called with the lock still held)
+static void record_release(LockStats* stats) {
+    long long hold_us = monotonic_time_us() - stats->hold_start_us;
+    stats->total_hold_us += hold_us;
+    if (hold_us > stats->max_hold_us) stats->max_hold_us = hold_us;
+    stats->hold_histogram[duration_bucket(hold_us)]++;
+}
+
+// Lock a mutex, measuring how long the caller waited for it
+int profiled_mutex_lock(pthread_mutex_t* mutex, const char* name, const char* file, int line) {
+    LockStats* stats = lookup_lock(mutex, name);
+
+    // Uncontended fast path
+    if (pthread_mutex_trylock(mutex) == 0) {
+        if (stats != NULL) record_acquisition(stats, file, line, 0, 0);
+        return 0;
+    }
+
+    long long start = monotonic_time_us();
+    int result = pthread_mutex_lock(mutex);
+    if (result == 0 && stats != NULL) {
+        record_acquisition(stats, file, line, monotonic_time_us() - start, 1);
+    }
+    return result;
+}
+
+// Unlock a mutex, recording how long it was held
+int profiled_mutex_unlock(pthread_mutex_t* mutex) {
+    LockStats* stats = lookup_lock(mutex, "unknown");
+    if (stats != NULL) record_release(stats);
+    return pthread_mutex_unlock(mutex);
+}
+
+// Wait on a condition variable - the wait itself is not counted as hold time
+int profiled_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, const char* name, const char* file, int line) {
+    LockStats* stats = lookup_lock(mutex, name);
+    if (stats != NULL) record_release(stats);
+
+    int result = pthread_cond_wait(cond, mutex);
+
+    if (stats != NULL) record_acquisition(stats, file, line, 0, 0);
+    return result;
+}
+
+// Upper bound (in microseconds) below which `percentile` of the samples fall
+static long long histogram_percentile(const unsigned long* histogram, unsigned long total, int percentile) {
+    if (total == 0) return 0;
+    unsigned long target = (total * percentile + 99) / 100;
+    unsigned long seen = 0;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= target) return i == 0 ? 1 : (1LL << i);
+    }
+    return 1LL << (PROFILE_BUCKETS - 1);
+}
+
+static int compare_by_wait(const void* a, const void* b) {
+    const LockStats* la = *(const LockStats* const*)a;
+    const LockStats* lb = *(const LockStats* const*)b;
+    return (lb->total_wait_us > la->total_wait_us) - (lb->total_wait_us < la->total_wait_us);
+}
+
+static int compare_sites_by_wait(const void* a, const void* b) {
+    const CallSite* sa = (const CallSite*)a;
+    const CallSite* sb = (const CallSite*)b;
+    return (sb->total_wait_us > sa->total_wait_us) - (sb->total_wait_us < sa->total_wait_us);
+}
+
+// Print where the threads of this process waited, most contended lock first
+void lock_profile_report() {
+    LockStats* locks[MAX_PROFILED_LOCKS];
+    int num_locks = 0;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < MAX_PROFILED_LOCKS; i++) {
+        if (atomic_load(&lock_table[i].mutex) != NULL && lock_table[i].acquisitions > 0) {
+            locks[num_locks++] = &lock_table[i];
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (num_locks == 0) return;
+    qsort(locks, num_locks, sizeof(LockStats*), compare_by_wait);
+
+    fprintf(stderr, "\n=== Lock contention profile (pid %d) ===\n", getpid());
+    fprintf(stderr, "%-28s %10s %10s %22s %22s\n", "lock", "acquired", "contended",
+            "wait avg/p99/max us", "hold avg/p99/max us");
+
+    for (int i = 0; i < num_locks; i++) {
+        LockStats* stats = locks[i];
+        char wait_text[32];
+        char hold_text[32];
+        snprintf(wait_text, sizeof(wait_text), "%lld/%lld/%lld",
+                 stats->total_wait_us / (long long)stats->acquisitions,
+                 histogram_percentile(stats->wait_histogram, stats->acquisitions, 99),
+                 stats->max_wait_us);
+        snprintf(hold_text, sizeof(hold_text), "%lld/%lld/%lld",
+                 stats->total_hold_us / (long long)stats->acquisitions,
+                 histogram_percentile(stats->hold_histogram, stats->acquisitions, 99),
+                 stats->max_hold_us);
+
+        fprintf(stderr, "%-28s %10lu %9.1f%% %22s %22s\n", stats->name, stats->acquisitions,
+                100.0 * stats->contended / stats->acquisitions, wait_text, hold_text);
+
+        // Top contended call sites
+        qsort(stats->sites, stats->num_sites, sizeof(CallSite), compare_sites_by_wait);
+        for (int j = 0; j < stats->num_sites && j < 3; j++) {
+            CallSite* site = &stats->sites[j];
+            if (site->contended == 0) break;
+            fprintf(stderr, "    %s:%d waited %lld us over %lu contended of %lu acquisitions\n",
+                    site->file, site->line, site->total_wait_us, site->contended, site->acquisitions);
+        }
+    }
+}
+
+#endif /* LOCK_PROFILE */
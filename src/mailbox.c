@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/mailbox.h"
+
+// Set up an empty mailbox holding at least `capacity` tips (rounded up to a power of two)
+bool mailbox_init(TipMailbox* mailbox, unsigned int capacity) {
+    if (capacity > MAILBOX_MAX_CAPACITY) capacity = MAILBOX_MAX_CAPACITY;
+    unsigned int size = 2;
+    while (size < capacity) size <<= 1;
+
+    mailbox->cells = (TipCell*)malloc(size * sizeof(TipCell));
+    if (mailbox->cells == NULL) {
+        perror("Failed to allocate mailbox");
+        mailbox->mask = 0;
+        return false;
+    }
+
+    // Cell i is free for the sender that claims position i
+    for (unsigned int i = 0; i < size; i++) {
+        atomic_init(&mailbox->cells[i].sequence, i);
+    }
+    mailbox->mask = size - 1;
+    atomic_init(&mailbox->tail, 0);
+    mailbox->head = 0;
+    atomic_init(&mailbox->dropped, 0);
+    return true;
+}
+
+// Release a mailbox's cells
+void mailbox_destroy(TipMailbox* mailbox) {
+    free(mailbox->cells);
+    mailbox->cells = NULL;
+}
+
+// Post a tip (any thread). False, and the tip counted as dropped, when the mailbox is full.
+bool mailbox_post(TipMailbox* mailbox, Tip tip) {
+    if (mailbox->cells == NULL) return false;
+
+    unsigned int position = atomic_load_explicit(&mailbox->tail, memory_order_relaxed);
+    TipCell* cell;
+    for (;;) {
+        cell = &mailbox->cells[position & mailbox->mask];
+        unsigned int sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int difference = (int)(sequence - position);
+
+        if (difference == 0) {
+            // Cell is free for this position - claim it
+            if (atomic_compare_exchange_weak_explicit(&mailbox->tail, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            // The owner has not taken the tip a full lap ago yet
+            atomic_fetch_add_explicit(&mailbox->dropped, 1, memory_order_relaxed);
+            return false;
+        }
+        else {
+            // Another sender claimed it first
+            position = atomic_load_explicit(&mailbox->tail, memory_order_relaxed);
+        }
+    }
+
+    cell->tip = tip;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+// Take the oldest tip (owner only). False when the mailbox is empty.
+bool mailbox_take(TipMailbox* mailbox, Tip* tip) {
+    if (mailbox->cells == NULL) return false;
+
+    TipCell* cell = &mailbox->cells[mailbox->head & mailbox->mask];
+    unsigned int sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if ((int)(sequence - (mailbox->head + 1)) < 0) {
+        return false;
+    }
+
+    *tip = cell->tip;
+
+    // Free the cell for the sender one lap ahead
+    atomic_store_explicit(&cell->sequence, mailbox->head + mailbox->mask + 1, memory_order_release);
+    mailbox->head++;
+    return true;
+}
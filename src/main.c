@@ -7,28 +7,47 @@
 #include <sys/msg.h>
 #include <errno.h>
 #include <pthread.h>
+#include <stdint.h>
 #include "../include/config.h"
 #include "../include/gang.h"
 #include "../include/police.h"
 #include "../include/ipc.h"
 #include "../include/utils.h"
 #include "../include/visualization.h"
+#include "../include/metrics.h"
+#include "../include/lock_profile.h"
+#include "../include/term_dashboard.h"
+#include "../include/state_stream.h"
+#include "../include/ingest.h"
+#include "../include/placement.h"
+#include "../include/investigation.h"
+#include "../include/outbox.h"
 
 // Global variables
 SimulationConfig config;
-VisualizationContext viz_context;
 SharedState* shared_state = NULL;
 int shm_id = -1;
 int sem_id = -1;
-int report_queue_id = -1;
-pid_t* gang_pids = NULL;
-pid_t police_pid = -1;
+int report_queue_ids[MAX_REPORT_PARTITIONS];    // One per police process, -1 once destroyed
+int metrics_shm_id = -1;
+int num_hosts = 0;                  // Gang host processes (or threads) running the gangs
+pid_t* host_pids = NULL;
+int num_police = 0;                 // Police processes (or threads), one per report partition
+pid_t* police_pids = NULL;
+pid_t metrics_pid = -1;
+pid_t stream_pid = -1;
+pthread_t* host_threads = NULL;     // --mode=threads only
+pthread_t* police_threads = NULL;   // --mode=threads only
 
 // Function to handle cleanup on exit
 void cleanup() {
+    // Ingestion reads shared memory and fills snapshot buffers - stop it first
+    ingest_stop();
+    
     // Clean up IPC resources
     if (shared_state != NULL) {
         detach_shared_memory(shared_state);
+        shared_state = NULL;
     }
     
     if (shm_id != -1) {
@@ -39,30 +58,44 @@ void cleanup() {
         destroy_semaphore_set(sem_id);
     }
     
-    if (report_queue_id != -1) {
-        destroy_report_queue(report_queue_id);
+    for (int i = 0; i < num_police; i++) {
+        if (report_queue_ids[i] != -1) {
+            destroy_report_queue(report_queue_ids[i]);
+        }
     }
     
-    // Clean up prep message queues
-    if (gang_pids != NULL) {
-        for (int i = 0; i < shared_state->num_gangs; i++) {
-            int prep_queue_id = msgget(REPORT_QUEUE_KEY + 1000 + i, 0666);
-            if (prep_queue_id != -1) {
-                msgctl(prep_queue_id, IPC_RMID, NULL);
-            }
-        }
+    if (metrics_registry != NULL) {
+        detach_metrics_registry(metrics_registry);
+        metrics_registry = NULL;
+    }
+    
+    if (metrics_shm_id != -1) {
+        destroy_metrics_registry(metrics_shm_id);
     }
     
     // Free allocated memory
-    if (gang_pids != NULL) {
-        free(gang_pids);
+    if (host_pids != NULL) {
+        free(host_pids);
     }
     
-    // Free visualization resources
-    if (viz_context.gang_states != NULL) {
-        free(viz_context.gang_states);
+    if (host_threads != NULL) {
+        free(host_threads);
     }
     
+    if (police_pids != NULL) {
+        free(police_pids);
+    }
+    
+    if (police_threads != NULL) {
+        free(police_threads);
+    }
+    
+    // Free visualization resources
+    viewer_state_cleanup();
+    // Give the terminal back before the snapshot buffers go away
+    term_dashboard_stop();
+    vis_snapshot_cleanup();
+    
     // Destroy mutex
     pthread_mutex_destroy(&viz_context.mutex);
     
@@ -79,15 +112,25 @@ void signal_handler(int sig) {
     }
     
     // Kill all child processes if we're in the parent
-    if (gang_pids != NULL) {
-        for (int i = 0; i < config.max_gangs; i++) {
-            if (gang_pids[i] > 0) {
-                kill(gang_pids[i], SIGTERM);
+    if (host_pids != NULL) {
+        for (int i = 0; i < num_hosts; i++) {
+            if (host_pids[i] > 0) {
+                kill(host_pids[i], SIGTERM);
+            }
+        }
+        
+        for (int i = 0; i < num_police; i++) {
+            if (police_pids != NULL && police_pids[i] > 0) {
+                kill(police_pids[i], SIGTERM);
             }
         }
         
-        if (police_pid > 0) {
-            kill(police_pid, SIGTERM);
+        if (metrics_pid > 0) {
+            kill(metrics_pid, SIGTERM);
+        }
+        
+        if (stream_pid > 0) {
+            kill(stream_pid, SIGTERM);
         }
     }
     
@@ -100,186 +143,369 @@ void signal_handler(int sig) {
     exit(0);
 }
 
-// Gang process main function
-void run_gang_process(int gang_id, SimulationConfig config) {
+// Publish a gang's dashboard record and member table so viewers can follow it
+// through shared memory
+static void publish_gang_vis(SharedState* shm, Gang* gang, int preparation_level) {
+    GangVisRecord record;
+    GangMemberRecord members[MAX_SHARED_MEMBERS];
+    
+    sim_mutex_lock(&gang->gang_mutex);
+    int num_agents = 0;
+    for (int i = 0; i < gang->num_members; i++) {
+        if (gang->members[i].is_secret_agent && gang->members[i].alive) {
+            num_agents++;
+        }
+    }
+    
+    int num_rows = gang->num_members < MAX_SHARED_MEMBERS ? gang->num_members : MAX_SHARED_MEMBERS;
+    for (int i = 0; i < num_rows; i++) {
+        GangMember* member = &gang->members[i];
+        int prep = gang->required_preparation_level > 0 ?
+                   member->preparation_level * 100 / gang->required_preparation_level : 0;
+        members[i].id = member->id;
+        members[i].rank = member->rank;
+        members[i].preparation = prep < 0 ? 0 : (prep > 100 ? 100 : prep);
+        members[i].knowledge = member->knowledge < 0 ? 0 : (member->knowledge > 100 ? 100 : member->knowledge);
+        members[i].flags = (member->is_secret_agent ? MEMBER_FLAG_AGENT : 0) |
+                           (member->alive ? MEMBER_FLAG_ALIVE : 0) |
+                           (member->in_prison ? MEMBER_FLAG_IN_PRISON : 0);
+    }
+    record.preparation_level = preparation_level;
+    record.current_target = gang->current_target;
+    record.num_members = gang->num_members;
+    record.num_agents = num_agents;
+    record.is_active = gang->is_active;
+    sim_mutex_unlock(&gang->gang_mutex);
+    
+    publish_gang_record(shm, gang->id, &record);
+    publish_member_table(shm, gang->id, members, num_rows);
+}
+
+// Add one sample of the gang's metrics to its history in shared memory
+static void record_gang_history(SharedState* shm, Gang* gang, int* reports_recorded) {
+    int values[HISTORY_METRICS];
+    
+    sim_mutex_lock(&gang->gang_mutex);
+    int total_prep = 0;
+    int total_knowledge = 0;
+    int num_agents = 0;
+    for (int i = 0; i < gang->num_members; i++) {
+        total_prep += gang->members[i].preparation_level;
+        if (gang->members[i].is_secret_agent && gang->members[i].alive) {
+            total_knowledge += gang->members[i].knowledge;
+            num_agents++;
+        }
+    }
+    int max_possible_prep = gang->num_members * gang->required_preparation_level;
+    values[HISTORY_PREPARATION] = max_possible_prep > 0 ? (total_prep * 100) / max_possible_prep : 0;
+    values[HISTORY_AGENT_KNOWLEDGE] = num_agents > 0 ? total_knowledge / num_agents : 0;
+    unsigned int reports_sent = outbox_reports_sent(gang->id);
+    values[HISTORY_REPORTS] = reports_sent - *reports_recorded;
+    values[HISTORY_ARRESTED] = gang->is_in_prison ? 100 : 0;
+    *reports_recorded = reports_sent;
+    sim_mutex_unlock(&gang->gang_mutex);
+    
+    history_record(&shm->gang_history[gang->id], values, monotonic_time_us() / 1000000);
+}
+
+// One gang driven by a gang host
+typedef struct {
     Gang gang;
+    SharedState* shm;
+    int time_spent_preparing;
+    int reports_recorded;
+    bool mission_planned;
+    long long next_tick_us;     // When the host runs the gang's next tick
+    bool finished;
+} GangRunner;
+
+// Set up a gang and plan its first mission
+static void gang_runner_start(GangRunner* runner, int gang_id, SharedState* shm, SimulationConfig config) {
+    Gang* gang = &runner->gang;
     
     // Initialize gang
     int num_members = random_int(config.min_members_per_gang, config.max_members_per_gang);
-    initialize_gang(&gang, gang_id, num_members, config.gang_ranks, config);
-    
-    // Set report queue ID
-    gang.report_queue_id = report_queue_id;
+    initialize_gang(gang, gang_id, num_members, config.gang_ranks, config);
     
-    // Attach to shared memory
-    SharedState* shm = attach_shared_memory(shm_id);
+    // Set report queue ID - the partition carrying this gang's reports
+    gang->report_queue_id = report_queue_ids[report_partition(gang_id)];
+    runner->shm = shm;
     
     // Plan initial mission
-    plan_new_mission(&gang, config);
+    plan_new_mission(gang, config);
+    publish_gang_vis(shm, gang, 0);
     
     // Track preparation time
-    int time_spent_preparing = 0;
-    bool mission_planned = true;
+    runner->time_spent_preparing = 0;
+    runner->reports_recorded = 0;
+    runner->mission_planned = true;
+    runner->next_tick_us = monotonic_time_us();
+    runner->finished = false;
+}
+
+// One iteration of a gang's loop. Returns the microseconds until its next
+// tick, or -1 once the simulation is over for the gang.
+static int gang_runner_tick(GangRunner* runner, SimulationConfig config) {
+    Gang* gang = &runner->gang;
+    SharedState* shm = runner->shm;
+    int gang_id = gang->id;
+    
+    long long tick_start = monotonic_time_us();
+    int sleep_us = 0;
+    
+    // Check if termination conditions are met
+    if (!shm->simulation_running ||
+        shm->total_successful_missions >= config.max_successful_plans ||
+        shm->total_thwarted_missions >= config.max_thwarted_plans ||
+        shm->total_executed_agents >= config.max_executed_agents) {
+        return -1;
+    }
     
-    // Main gang loop
-    while (shm->simulation_running) {
-        // Check if termination conditions are met
-        if (shm->total_successful_missions >= config.max_successful_plans ||
-            shm->total_thwarted_missions >= config.max_thwarted_plans ||
-            shm->total_executed_agents >= config.max_executed_agents) {
-            break;
-        }
+    // Check for arrest notification from police
+    semaphore_wait(sem_id, 0);
+    if (shm->gang_status[gang_id].is_arrested && !shm->gang_status[gang_id].arrest_notification_seen) {
+        // Gang has been arrested - process notification
+        gang->is_in_prison = true;
+        gang->prison_time_remaining = shm->gang_status[gang_id].prison_time;
+        shm->gang_status[gang_id].arrest_notification_seen = true;
+        publish_state_change(shm);
         
-        // Check for arrest notification from police
-        semaphore_wait(sem_id, 0);
-        if (shm->gang_status[gang_id].is_arrested && !shm->gang_status[gang_id].arrest_notification_seen) {
-            // Gang has been arrested - process notification
-            gang.is_in_prison = true;
-            gang.prison_time_remaining = shm->gang_status[gang_id].prison_time;
-            shm->gang_status[gang_id].arrest_notification_seen = true;
-            
-            // Reset mission planning
-            time_spent_preparing = 0;
-            mission_planned = false;
-            
-            // Signal all gang member threads
-            pthread_mutex_lock(&gang.gang_mutex);
-            log_message("Gang %d has been arrested, %d members sent to prison for %d time units",
-                       gang_id, gang.num_members, gang.prison_time_remaining);
-            pthread_mutex_unlock(&gang.gang_mutex);
-        }
-        semaphore_signal(sem_id, 0);
+        // Reset mission planning
+        runner->time_spent_preparing = 0;
+        runner->mission_planned = false;
         
-        // Gang operations
-        if (!gang.is_in_prison) {
-            // Check if we're preparing or ready to execute
-            if (mission_planned) {
-                // Check if preparation time has elapsed
-                if (time_spent_preparing >= gang.preparation_time) {
-                    // Store previous mission counts to detect changes
-                    int prev_successful = gang.successful_missions;
-                    int prev_thwarted = gang.thwarted_missions;
-                    int prev_executed = gang.executed_agents;
-                    
-                    // Execute mission
-                    execute_mission(&gang, config);
-                    
-                    // Update shared memory based on mission outcome
-                    semaphore_wait(sem_id, 0);
-                    if (gang.successful_missions > prev_successful) {
-                        shm->total_successful_missions++;
-                        log_message("Gang %d mission succeeded - total successful missions: %d", 
-                                   gang_id, shm->total_successful_missions);
-                    }
-                    if (gang.thwarted_missions > prev_thwarted) {
-                        shm->total_thwarted_missions++;
-                        log_message("Gang %d mission failed - total thwarted missions: %d", 
-                                   gang_id, shm->total_thwarted_missions);
+        // Signal all gang member threads
+        sim_mutex_lock(&gang->gang_mutex);
+        log_message("Gang %d has been arrested, %d members sent to prison for %d time units",
+                   gang_id, gang->num_members, gang->prison_time_remaining);
+        sim_mutex_unlock(&gang->gang_mutex);
+    }
+    semaphore_signal(sem_id, 0);
+    
+    // Gang operations
+    if (!gang->is_in_prison) {
+        // Check if we're preparing or ready to execute
+        if (runner->mission_planned) {
+            // Check if preparation time has elapsed
+            if (runner->time_spent_preparing >= gang->preparation_time) {
+                // Store previous mission counts to detect changes
+                int prev_successful = gang->successful_missions;
+                int prev_thwarted = gang->thwarted_missions;
+                int prev_executed = gang->executed_agents;
+                
+                // Execute mission
+                execute_mission(gang, config);
+                
+                // Update shared memory based on mission outcome
+                semaphore_wait(sem_id, 0);
+                if (gang->successful_missions > prev_successful) {
+                    shm->total_successful_missions++;
+                    METRICS_INC(missions_succeeded);
+                    log_message("Gang %d mission succeeded - total successful missions: %d", 
+                               gang_id, shm->total_successful_missions);
+                }
+                if (gang->thwarted_missions > prev_thwarted) {
+                    shm->total_thwarted_missions++;
+                    METRICS_INC(missions_failed);
+                    log_message("Gang %d mission failed - total thwarted missions: %d", 
+                               gang_id, shm->total_thwarted_missions);
+                }
+                if (gang->executed_agents > prev_executed) {
+                    shm->total_executed_agents += (gang->executed_agents - prev_executed);
+                    if (metrics_registry != NULL) {
+                        atomic_fetch_add_explicit(&metrics_registry->agents_executed.value,
+                                                  gang->executed_agents - prev_executed, memory_order_relaxed);
                     }
-                    if (gang.executed_agents > prev_executed) {
-                        shm->total_executed_agents += (gang.executed_agents - prev_executed);
-                        log_message("Gang %d executed %d agents - total executed agents: %d", 
-                                   gang_id, (gang.executed_agents - prev_executed), shm->total_executed_agents);
+                    log_message("Gang %d executed %d agents - total executed agents: %d", 
+                               gang_id, (gang->executed_agents - prev_executed), shm->total_executed_agents);
+                }
+                publish_state_change(shm);
+                semaphore_signal(sem_id, 0);
+                
+                // Plan next mission
+                plan_new_mission(gang, config);
+                runner->time_spent_preparing = 0;
+                publish_gang_vis(shm, gang, 0);
+            } else {
+                // Continue preparing
+                runner->time_spent_preparing++;
+                
+                // Log preparation status periodically
+                if (runner->time_spent_preparing % 2 == 0) {
+                    int total_prep = 0;
+                    int max_possible_prep = 0;
+                    sim_mutex_lock(&gang->gang_mutex);
+                    for (int i = 0; i < gang->num_members; i++) {
+                        total_prep += gang->members[i].preparation_level;
+                        max_possible_prep += gang->required_preparation_level;
                     }
-                    semaphore_signal(sem_id, 0);
-                    
-                    // Plan next mission
-                    plan_new_mission(&gang, config);
-                    time_spent_preparing = 0;
-                } else {
-                    // Continue preparing
-                    time_spent_preparing++;
+                    // Calculate as percentage of required level
+                    int avg_prep = max_possible_prep > 0 ? (total_prep * 100) / max_possible_prep : 0;
+                    sim_mutex_unlock(&gang->gang_mutex);
                     
-                    // Log preparation status periodically
-                    if (time_spent_preparing % 2 == 0) {
-                        int total_prep = 0;
-                        int max_possible_prep = 0;
-                        pthread_mutex_lock(&gang.gang_mutex);
-                        for (int i = 0; i < gang.num_members; i++) {
-                            total_prep += gang.members[i].preparation_level;
-                            max_possible_prep += gang.required_preparation_level;
-                        }
-                        // Calculate as percentage of required level
-                        int avg_prep = max_possible_prep > 0 ? (total_prep * 100) / max_possible_prep : 0;
-                        pthread_mutex_unlock(&gang.gang_mutex);
-                        
-                        log_message("Gang %d preparing for %s: %d/%d time units, %d%% prepared", 
-                                   gang.id, crime_type_to_string(gang.current_target),
-                                   time_spent_preparing, gang.preparation_time, avg_prep);
-                        
-                        // Send preparation level to visualization through message queue
-                        int prep_queue_id = msgget(REPORT_QUEUE_KEY + 1000 + gang.id, IPC_CREAT | 0666);
-                        if (prep_queue_id != -1) {
-                            struct {
-                                long mtype;
-                                int preparation_level;
-                                CrimeType current_target;
-                                int num_members;
-                            } prep_msg;
-                            
-                            prep_msg.mtype = 2; // Message type 2 for preparation updates
-                            prep_msg.preparation_level = avg_prep;
-                            prep_msg.current_target = gang.current_target;
-                            prep_msg.num_members = gang.num_members;
-                            
-                            msgsnd(prep_queue_id, &prep_msg, sizeof(prep_msg) - sizeof(long), IPC_NOWAIT);
-                        }
-                    }
+                    log_message("Gang %d preparing for %s: %d/%d time units, %d%% prepared", 
+                               gang->id, crime_type_to_string(gang->current_target),
+                               runner->time_spent_preparing, gang->preparation_time, avg_prep);
                     
-                    // Sleep to simulate time passing and avoid busy waiting
-                    usleep(500000); // Sleep for 0.5 seconds
+                    // Dashboard record for read-only viewers
+                    publish_gang_vis(shm, gang, avg_prep);
                 }
-            } else {
-                // Plan new mission if we don't have one
-                plan_new_mission(&gang, config);
-                time_spent_preparing = 0;
-                mission_planned = true;
+                
+                // Sleep to simulate time passing and avoid busy waiting
+                sleep_us = 500000; // Sleep for 0.5 seconds
             }
+        } else {
+            // Plan new mission if we don't have one
+            plan_new_mission(gang, config);
+            runner->time_spent_preparing = 0;
+            runner->mission_planned = true;
+            publish_gang_vis(shm, gang, 0);
         }
-        else {
-            // Gang is in prison, decrease prison time
-            gang.prison_time_remaining--;
-            if (gang.prison_time_remaining <= 0) {
-                gang.is_in_prison = false;
-                
-                // Update shared memory to clear arrest status
-                semaphore_wait(sem_id, 0);
-                shm->gang_status[gang_id].is_arrested = false;
-                semaphore_signal(sem_id, 0);
-                
-                log_message("Gang %d has been released from prison", gang_id);
-                
-                // Signal all gang member threads to resume operations
-                pthread_mutex_lock(&gang.gang_mutex);
-                pthread_cond_broadcast(&gang.gang_cond);
-                pthread_mutex_unlock(&gang.gang_mutex);
+    }
+    else {
+        // Gang is in prison, decrease prison time
+        gang->prison_time_remaining--;
+        if (gang->prison_time_remaining <= 0) {
+            gang->is_in_prison = false;
+            
+            // Update shared memory to clear arrest status
+            semaphore_wait(sem_id, 0);
+            shm->gang_status[gang_id].is_arrested = false;
+            publish_state_change(shm);
+            semaphore_signal(sem_id, 0);
+            
+            log_message("Gang %d has been released from prison", gang_id);
+            
+            // Signal all gang member threads to resume operations
+            sim_mutex_lock(&gang->gang_mutex);
+            pthread_cond_broadcast(&gang->gang_cond);
+            sim_mutex_unlock(&gang->gang_mutex);
+        }
+        sleep_us = 1000000; // Sleep to avoid busy waiting
+    }
+    
+    // Sample the history and record how long this iteration worked
+    if (gang_id < MAX_SHARED_GANGS) {
+        record_gang_history(shm, gang, &runner->reports_recorded);
+    }
+    metrics_observe_gang_tick(gang_id, monotonic_time_us() - tick_start);
+    return sleep_us;
+}
+
+// Gang host main function - drives gangs first_gang, first_gang + stride, ...
+// below num_gangs on a single tick loop, always running the gang due next
+void run_gang_host(int first_gang, int stride, int num_gangs, SimulationConfig config) {
+    int count = 0;
+    for (int id = first_gang; id < num_gangs; id += stride) {
+        count++;
+    }
+    if (count == 0) return;
+    
+    // Member threads created below inherit the host's CPU
+    placement_pin_thread(PLACEMENT_ROLE_GANG_HOST, first_gang);
+    
+    GangRunner* runners = (GangRunner*)calloc(count, sizeof(GangRunner));
+    if (runners == NULL) {
+        perror("Failed to allocate gang runners");
+        return;
+    }
+    
+    // Attach to shared memory
+    SharedState* shm = attach_shared_memory(shm_id);
+    
+    for (int i = 0; i < count; i++) {
+        gang_runner_start(&runners[i], first_gang + i * stride, shm, config);
+    }
+    log_message("Gang host %d running %d gangs", first_gang, count);
+    
+    // Main host loop
+    int remaining = count;
+    while (remaining > 0) {
+        // Next gang due
+        GangRunner* due = NULL;
+        for (int i = 0; i < count; i++) {
+            if (!runners[i].finished && (due == NULL || runners[i].next_tick_us < due->next_tick_us)) {
+                due = &runners[i];
             }
-            sleep(1); // Sleep to avoid busy waiting
+        }
+        
+        long long wait_us = due->next_tick_us - monotonic_time_us();
+        if (wait_us > 0) {
+            usleep(wait_us);
+        }
+        
+        int sleep_us = gang_runner_tick(due, config);
+        if (sleep_us < 0) {
+            due->finished = true;
+            remaining--;
+        } else {
+            due->next_tick_us = monotonic_time_us() + sleep_us;
         }
     }
     
     // Cleanup
-    cleanup_gang(&gang);
+    for (int i = 0; i < count; i++) {
+        cleanup_gang(&runners[i].gang);
+    }
+    free(runners);
     detach_shared_memory(shm);
+}
+
+// Gang host process main function
+void run_gang_host_process(int host, int num_hosts, int num_gangs, SimulationConfig config) {
+    outbox_start(report_queue_ids, config.outbox_flush_ms);
+    run_gang_host(host, num_hosts, num_gangs, config);
+    outbox_stop();
     exit(0);
 }
 
-// Police process main function
-void run_police_process(SimulationConfig config) {
+// Gang host thread main function (--mode=threads)
+static void* gang_host_thread_func(void* arg) {
+    run_gang_host((int)(intptr_t)arg, num_hosts, shared_state->num_gangs, config);
+    return NULL;
+}
+
+// Police main function for one report partition - returns once the simulation
+// ends. This thread is the ingestion stage of the police pipeline: it only
+// receives the partition's reports and routes them to the police shards.
+void run_police(int partition, SimulationConfig config) {
     Police police;
     
-    // Initialize police
-    initialize_police(&police, config);
-    
-    // Set report queue ID
-    police.report_queue_id = report_queue_id;
-    
     // Attach to shared memory
     SharedState* shm = attach_shared_memory(shm_id);
     
-    // Create police thread
-    pthread_t police_thread;
-    pthread_create(&police_thread, NULL, police_routine, &police);
+    // Gangs reporting to this partition
+    int partition_gangs = 0;
+    for (int gang_id = 0; gang_id < shm->num_gangs; gang_id++) {
+        if (report_partition(gang_id) == partition) partition_gangs++;
+    }
+    
+    // By default the police processes share the cores - with placement, the
+    // police CPUs - one shard per core; never more shards than there are gangs
+    int num_shards = config.police_threads;
+    if (num_shards <= 0 && placement_enabled()) {
+        num_shards = placement_role_cpus(PLACEMENT_ROLE_POLICE_WORKER) / report_partitions;
+    }
+    else if (num_shards <= 0) {
+        num_shards = (int)sysconf(_SC_NPROCESSORS_ONLN) / report_partitions;
+    }
+    if (num_shards > partition_gangs) num_shards = partition_gangs;
+    if (num_shards < 1) num_shards = 1;
+    
+    // Run on the first CPU of this process's block of police CPUs. The
+    // decision and arrest threads created below inherit it; the shards pin
+    // themselves to the CPUs of the block
+    placement_pin_thread(PLACEMENT_ROLE_POLICE, partition * num_shards);
+    
+    // Initialize police
+    if (!initialize_police(&police, partition, num_shards, config)) {
+        detach_shared_memory(shm);
+        return;
+    }
+    
+    // Set report queue ID
+    police.report_queue_id = report_queue_ids[partition];
+    int synced_lost_agents = 0;
     
     // Main police loop
     while (shm->simulation_running) {
@@ -290,233 +516,112 @@ void run_police_process(SimulationConfig config) {
             break;
         }
         
-        // Process intelligence and take action
+        // Hand intelligence to the shard owning the gang, waiting while it is backed up
         IntelligenceReport report;
-        if (receive_report(report_queue_id, &report) > 0) {
-            process_intelligence(&police, report, config);
-            
-            // Check if action should be taken
-            if (decide_on_action(&police, report.gang_id, config)) {
-                arrest_gang_members(&police, report.gang_id, config);
-                
-                // Update shared memory
-                semaphore_wait(sem_id, 0);
-                shm->total_thwarted_missions++;
-                semaphore_signal(sem_id, 0);
+        long long sent_us;
+        if (receive_report(police.report_queue_id, &report, &sent_us) > 0) {
+            while (!route_intelligence(&police, report, sent_us) && shm->simulation_running) {
+                usleep(1000);
             }
         }
         
-        // Update shared memory with lost agents
-        semaphore_wait(sem_id, 0);
-        shm->total_executed_agents = police.lost_agents;
-        semaphore_signal(sem_id, 0);
+        // Add this partition's newly lost agents to shared memory - the other
+        // police processes add theirs
+        int lost_agents = atomic_load(&police.lost_agents);
+        if (lost_agents != synced_lost_agents) {
+            semaphore_wait(sem_id, 0);
+            shm->total_executed_agents += lost_agents - synced_lost_agents;
+            publish_state_change(shm);
+            semaphore_signal(sem_id, 0);
+            synced_lost_agents = lost_agents;
+        }
     }
     
-    // Wait for police thread to finish
-    pthread_join(police_thread, NULL);
+    // Wait for the police shards to finish
+    stop_police(&police);
     
     // Cleanup
     cleanup_police(&police);
     detach_shared_memory(shm);
+}
+
+// Police process main function
+void run_police_process(int partition, SimulationConfig config) {
+    run_police(partition, config);
     exit(0);
 }
 
-// Thread function for visualization loop
-void* visualization_thread_func(void* arg) {
-    printf("Starting visualization thread...\n");
-    
-    // Mark thread as running and initialize health counter
-    pthread_mutex_lock(&viz_context.mutex);
-    viz_context.viz_thread_running = true;
-    viz_context.viz_thread_health = 1;
-    pthread_mutex_unlock(&viz_context.mutex);
-    
-    // Check if DISPLAY environment is available
-    char* display = getenv("DISPLAY");
-    if (!display || strlen(display) == 0) {
-        fprintf(stderr, "Warning: No DISPLAY environment variable set. Falling back to text-only mode.\n");
-        // Text-only mode - enhanced version
-        int frame = 0;
-        while (1) {
-            // Thread-safe access to simulation status
-            bool keep_running;
-            pthread_mutex_lock(&viz_context.mutex);
-            keep_running = viz_context.simulation_running;
-            viz_context.viz_thread_health++; // Increment health counter
-            pthread_mutex_unlock(&viz_context.mutex);
-            
-            if (!keep_running) break;
-            
-            if (frame++ % 5 == 0) {  // Update every 5 frames
-                // Clear screen and print header (ANSI escape sequences)
-                printf("\033[2J\033[H");  // Clear screen and move cursor to top
-                printf("===== Crime Simulation Text Visualization - Frame %d =====\n\n", frame);
-                
-                // Display gang information - thread-safe access
-                pthread_mutex_lock(&viz_context.mutex);
-                printf("Gangs:\n");
-                for (int i = 0; i < viz_context.num_gangs; i++) {
-                    if (viz_context.gang_states != NULL) {
-                        printf("  Gang %d: %s\n", i, 
-                            viz_context.gang_states[i].is_in_prison ? "In Prison" : "Active");
-                        printf("    Members: %d, Agents: %d\n", 
-                            viz_context.gang_states[i].num_members,
-                            viz_context.gang_states[i].num_agents);
-                        printf("    Preparation: %d%%\n", 
-                            viz_context.gang_states[i].preparation_level);
-                        printf("    Target: %s\n\n", 
-                            crime_type_to_string(viz_context.gang_states[i].current_target));
-                    }
-                }
-                
-                // Display simulation statistics
-                if (viz_context.shared_state != NULL) {
-                    printf("\nStatistics:\n");
-                    printf("  Successful missions: %d / %d\n", 
-                        viz_context.shared_state->total_successful_missions,
-                        viz_context.config.max_successful_plans);
-                    printf("  Thwarted missions: %d / %d\n", 
-                        viz_context.shared_state->total_thwarted_missions,
-                        viz_context.config.max_thwarted_plans);
-                    printf("  Executed agents: %d / %d\n", 
-                        viz_context.shared_state->total_executed_agents,
-                        viz_context.config.max_executed_agents);
-                    printf("  Animation time: %.1f\n", 
-                        viz_context.animation_time);
-                }
-                pthread_mutex_unlock(&viz_context.mutex);
-            }
-            usleep(viz_context.refresh_rate * 1000); // Convert ms to μs
-        }
-        
-        // Mark thread as stopped before exiting
-        pthread_mutex_lock(&viz_context.mutex);
-        viz_context.viz_thread_running = false;
-        pthread_mutex_unlock(&viz_context.mutex);
-        return NULL;
-    }
-    
-    // In graphical mode, this thread should only update data periodically,
-    // NOT try to run the GLUT main loop (which should run in the main thread)
-    printf("Visualization thread started in graphical mode, will update data only\n");
-    
-    int frame = 0;
-    while (1) {
-        // Thread-safe access to simulation status
-        bool keep_running;
-        pthread_mutex_lock(&viz_context.mutex);
-        keep_running = viz_context.simulation_running;
-        viz_context.viz_thread_health++; // Increment health counter
-        
-        // Update animation time
-        viz_context.animation_time += 0.1f;
-        pthread_mutex_unlock(&viz_context.mutex);
-        
-        if (!keep_running) break;
-        
-        // Request a redraw
-        glutPostRedisplay();
-        
-        usleep(viz_context.refresh_rate * 1000); // Convert ms to μs
-    }
-    
-    // Mark thread as stopped before exiting
-    pthread_mutex_lock(&viz_context.mutex);
-    viz_context.viz_thread_running = false;
-    pthread_mutex_unlock(&viz_context.mutex);
+// Police thread main function (--mode=threads)
+static void* police_thread_func(void* arg) {
+    run_police((int)(intptr_t)arg, config);
     return NULL;
 }
 
-// Thread function for state updates
-void* gang_state_update_thread(void* arg) {
-    int num_gangs = shared_state->num_gangs;
-    bool simulation_ended = false;
-    
-    // Process update loop that runs alongside glutMainLoop
-    while (1) {  // Keep running even if simulation ends
-        // Check if we've reached termination conditions
-        bool sim_running = shared_state->simulation_running;
-        
-        // If simulation just ended, print a message
-        if (sim_running == false && simulation_ended == false) {
-            simulation_ended = true;
-            printf("Simulation has ended, but visualization will continue\n");
+int main(int argc, char* argv[]) {
+    // Check command line arguments
+    const char* config_file = NULL;
+    bool export_metrics = false;
+    bool headless = false;
+    bool stream_state = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--metrics") == 0) {
+            export_metrics = true;
         }
-        
-        // Update gang visualization states from shared memory
-        for (int i = 0; i < num_gangs; i++) {
-            pthread_mutex_lock(&viz_context.mutex);
-            // Update arrest status
-            viz_context.gang_states[i].is_in_prison = shared_state->gang_status[i].is_arrested;
-            viz_context.gang_states[i].prison_time_remaining = shared_state->gang_status[i].prison_time;
-            pthread_mutex_unlock(&viz_context.mutex);
-            
-            // Update preparation level - get this data through a message queue
-            int msg_queue_id = msgget(REPORT_QUEUE_KEY + 1000 + i, 0666);
-            if (msg_queue_id != -1) {
-                // Try to receive an update message without blocking
-                struct {
-                    long mtype;
-                    int preparation_level;
-                    CrimeType current_target;
-                    int num_members;
-                } prep_msg;
-                
-                if (msgrcv(msg_queue_id, &prep_msg, sizeof(prep_msg) - sizeof(long), 2, IPC_NOWAIT) != -1) {
-                    // Update visualization with thread safety
-                    pthread_mutex_lock(&viz_context.mutex);
-                    viz_context.gang_states[i].preparation_level = prep_msg.preparation_level;
-                    viz_context.gang_states[i].current_target = prep_msg.current_target;
-                    viz_context.gang_states[i].num_members = prep_msg.num_members;
-                    pthread_mutex_unlock(&viz_context.mutex);
-                    
-                    // Only print updates occasionally to avoid console spam
-                    static int update_count = 0;
-                    if (update_count++ % 10 == 0) {
-                        printf("Queue %d: Updated gang %d preparation: %d%%, target: %s, members: %d\n", 
-                               msg_queue_id, i, prep_msg.preparation_level, 
-                               crime_type_to_string(prep_msg.current_target), 
-                               prep_msg.num_members);
-                    }
-                }
-            }
+        else if (strcmp(argv[i], "--stream") == 0) {
+            stream_state = true;
         }
-        
-        // If we've reached termination conditions but need to keep the visualization alive
-        if (simulation_ended) {
-            // Occasionally generate new preparation values for the gangs to make visualization interesting
-            static int update_cycle = 0;
-            if (update_cycle++ % 50 == 0) {
-                for (int i = 0; i < num_gangs; i++) {
-                    // Only update gangs that aren't in prison
-                    pthread_mutex_lock(&viz_context.mutex);
-                    if (!viz_context.gang_states[i].is_in_prison) {
-                        // Randomly change preparation level
-                        viz_context.gang_states[i].preparation_level = random_int(5, 95);
-                        
-                        // Randomly change crime type
-                        viz_context.gang_states[i].current_target = (CrimeType)random_int(0, NUM_CRIME_TYPES - 1);
-                    }
-                    pthread_mutex_unlock(&viz_context.mutex);
-                }
+        else if (strcmp(argv[i], "--mode=threads") == 0) {
+            ipc_mode = IPC_MODE_THREADS;
+        }
+        else if (strcmp(argv[i], "--mode=processes") == 0) {
+            ipc_mode = IPC_MODE_PROCESSES;
+        }
+        else if (strncmp(argv[i], "--mode=", 7) == 0) {
+            fprintf(stderr, "Mode must be threads or processes\n");
+            return 1;
+        }
+        else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+        else if (strncmp(argv[i], "--run-id=", 9) == 0) {
+            ipc_run_id = atoi(argv[i] + 9);
+            if (ipc_run_id < 0 || ipc_run_id > MAX_RUN_ID) {
+                fprintf(stderr, "Run id must be between 0 and %d\n", MAX_RUN_ID);
+                return 1;
             }
         }
-        
-        // Sleep to avoid busy waiting
-        usleep(200000); // 0.2 seconds
+        else if (config_file == NULL) {
+            config_file = argv[i];
+        }
     }
-    return NULL;
-}
-
-int main(int argc, char* argv[]) {
-    // Check command line arguments
-    if (argc < 2) {
-        printf("Usage: %s <config_file>\n", argv[0]);
+    
+    if (config_file == NULL) {
+        printf("Usage: %s <config_file> [--metrics] [--stream] [--mode=threads|processes] [--run-id=N] [--headless]\n", argv[0]);
         return 1;
     }
     
     // Load configuration
-    config = load_config(argv[1]);
+    config = load_config(config_file);
+    
+    // Reports this suspicious travel on the urgent lanes of the report queue
+    report_lane_threshold = config.police_action_threshold;
+    
+    // Scoring weights are set once and inherited by every gang host
+    if (!investigation_configure(config.investigation_scoring)) {
+        fprintf(stderr, "Keeping the default investigation scoring: %s\n", DEFAULT_INVESTIGATION_SCORING);
+    }
+    
+    // Pin the coordinator before it starts any thread, so they all inherit its CPU
+    placement_init(config.placement);
+    placement_pin_thread(PLACEMENT_ROLE_VIEWER, 0);
+    
+    // Headless runs on a terminal get the terminal dashboard. It needs the terminal
+    // to itself, so it takes over before any child process inherits stdout.
+    char* display_env = getenv("DISPLAY");
+    if (!headless && (!display_env || strlen(display_env) == 0) && term_dashboard_start(config.terminal_log_file)) {
+        printf("Terminal dashboard active, simulation output is logged here\n");
+    }
+    
     print_config(config);
     
     // Initialize random seed
@@ -541,53 +646,166 @@ int main(int argc, char* argv[]) {
         shared_state->gang_status[i].arrest_notification_seen = true;
     }
     
+    // A reused segment must not show records or history of a previous run
+    memset(shared_state->gang_vis, 0, sizeof(shared_state->gang_vis));
+    memset(shared_state->member_tables, 0, sizeof(shared_state->member_tables));
+    memset(shared_state->gang_history, 0, sizeof(shared_state->gang_history));
+    
     sem_id = create_semaphore_set();
-    report_queue_id = create_report_queue();
+    
+    // Metrics registry - attached before forking so every process inherits it
+    metrics_shm_id = create_metrics_registry();
+    if (metrics_shm_id != -1) {
+        metrics_registry = attach_metrics_registry(metrics_shm_id);
+    }
     
     // Determine number of gangs
     int num_gangs = random_int(config.min_gangs, config.max_gangs);
+    if (num_gangs > MAX_SHARED_GANGS) {
+        num_gangs = MAX_SHARED_GANGS;
+    }
     shared_state->num_gangs = num_gangs;
+    METRICS_SET(num_gangs, num_gangs);
     printf("Creating %d gangs for simulation.\n", num_gangs);
     
-    // Allocate memory for gang PIDs
-    gang_pids = (pid_t*)malloc(num_gangs * sizeof(pid_t));
+    // Gangs are spread round-robin over the gang hosts, one per core by default
+    num_hosts = config.gang_hosts > 0 ? config.gang_hosts : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_hosts < 1) {
+        num_hosts = 1;
+    }
+    if (num_hosts > num_gangs) {
+        num_hosts = num_gangs;
+    }
+    printf("Running the gangs on %d gang hosts.\n", num_hosts);
+    
+    // Each police process consumes one partition of the report queue,
+    // covering a contiguous range of gang ids
+    num_police = config.police_processes;
+    if (num_police > MAX_REPORT_PARTITIONS) {
+        num_police = MAX_REPORT_PARTITIONS;
+    }
+    if (num_police > num_gangs) {
+        num_police = num_gangs;
+    }
+    if (num_police < 1) {
+        num_police = 1;
+    }
+    report_partitions = num_police;
+    report_partition_gangs = num_gangs;
+    for (int i = 0; i < num_police; i++) {
+        report_queue_ids[i] = create_report_queue(i);
+    }
+    printf("Running the police in %d processes.\n", num_police);
+    placement_reserve_police(num_police, config.police_threads);
+    
+    // The gang hosts write the shared segments most, keep them on their node(s)
+    placement_bind_memory(shared_state, sizeof(SharedState), PLACEMENT_ROLE_GANG_HOST, num_hosts);
+    if (metrics_registry != NULL) {
+        placement_bind_memory(metrics_registry, sizeof(MetricsRegistry), PLACEMENT_ROLE_GANG_HOST, num_hosts);
+    }
+    
+    // Allocate memory for gang host and police PIDs
+    host_pids = (pid_t*)calloc(num_hosts, sizeof(pid_t));
+    police_pids = (pid_t*)calloc(num_police, sizeof(pid_t));
     
-    // Create gang processes
-    for (int i = 0; i < num_gangs; i++) {
-        pid_t pid = fork();
+    // Create gang host and police processes. Threaded runs start theirs once the side
+    // processes are forked, so no child inherits a lock held by a running thread.
+    if (ipc_mode == IPC_MODE_PROCESSES) {
+        // Create gang host processes
+        for (int i = 0; i < num_hosts; i++) {
+            pid_t pid = fork();
+            
+            if (pid < 0) {
+                // Fork failed
+                perror("Fork failed");
+                signal_handler(SIGTERM);
+                return 1;
+            }
+            else if (pid == 0) {
+                // Child process (gang host)
+                run_gang_host_process(i, num_hosts, num_gangs, config);
+                // Should not return
+                exit(0);
+            }
+            else {
+                // Parent process
+                host_pids[i] = pid;
+            }
+        }
         
-        if (pid < 0) {
-            // Fork failed
-            perror("Fork failed");
-            signal_handler(SIGTERM);
-            return 1;
+        // Create police processes, one per report partition
+        for (int i = 0; i < num_police; i++) {
+            pid_t pid = fork();
+            
+            if (pid < 0) {
+                // Fork failed
+                perror("Fork failed");
+                signal_handler(SIGTERM);
+                return 1;
+            }
+            else if (pid == 0) {
+                // Child process (police)
+                run_police_process(i, config);
+                // Should not return
+                exit(0);
+            }
+            else {
+                // Parent process
+                police_pids[i] = pid;
+            }
         }
-        else if (pid == 0) {
-            // Child process (gang)
-            run_gang_process(i, config);
-            // Should not return
-            exit(0);
+    }
+        
+    // Create metrics exporter process if requested
+    if (export_metrics) {
+        metrics_pid = fork();
+        
+        if (metrics_pid < 0) {
+            perror("Fork failed for metrics exporter");
         }
-        else {
-            // Parent process
-            gang_pids[i] = pid;
+        else if (metrics_pid == 0) {
+            // Child process (metrics exporter)
+            // The in-memory queue of a threaded run is not visible to it
+            run_metrics_exporter(config, ipc_mode == IPC_MODE_PROCESSES ? report_queue_ids : NULL);
+            exit(0);
         }
     }
     
-    // Create police process
-    police_pid = fork();
-    
-    if (police_pid < 0) {
-        // Fork failed
-        perror("Fork failed");
-        signal_handler(SIGTERM);
-        return 1;
+    // Create state stream process if requested - it only reads shared memory,
+    // so its clients can never slow the simulation down
+    if (stream_state) {
+        stream_pid = fork();
+        
+        if (stream_pid < 0) {
+            perror("Fork failed for state stream");
+        }
+        else if (stream_pid == 0) {
+            // Child process (state stream)
+            run_state_stream(config, shared_state);
+            exit(0);
+        }
     }
-    else if (police_pid == 0) {
-        // Child process (police)
-        run_police_process(config);
-        // Should not return
-        exit(0);
+    
+    // Threaded runs host every gang and the police in this process
+    if (ipc_mode == IPC_MODE_THREADS) {
+        outbox_start(report_queue_ids, config.outbox_flush_ms);
+        host_threads = (pthread_t*)malloc(num_hosts * sizeof(pthread_t));
+        for (int i = 0; i < num_hosts; i++) {
+            if (pthread_create(&host_threads[i], NULL, gang_host_thread_func, (void*)(intptr_t)i) != 0) {
+                perror("Failed to create gang host thread");
+                signal_handler(SIGTERM);
+                return 1;
+            }
+        }
+        
+        police_threads = (pthread_t*)malloc(num_police * sizeof(pthread_t));
+        for (int i = 0; i < num_police; i++) {
+            if (pthread_create(&police_threads[i], NULL, police_thread_func, (void*)(intptr_t)i) != 0) {
+                perror("Failed to create police thread");
+                signal_handler(SIGTERM);
+                return 1;
+            }
+        }
     }
     
     // Initialize visualization 
@@ -603,7 +821,7 @@ int main(int argc, char* argv[]) {
     viz_context.shared_state = shared_state;
     viz_context.viz_thread_running = false;
     viz_context.viz_thread_health = 0;
-
+    
     // Initialize mutex for thread-safe access to visualization data
     if (pthread_mutex_init(&viz_context.mutex, NULL) != 0) {
         perror("Failed to initialize visualization mutex");
@@ -611,9 +829,24 @@ int main(int argc, char* argv[]) {
         // Continue, don't terminate
     }
     
-    // Check if we have a DISPLAY environment variable before trying OpenGL
-    char* display = getenv("DISPLAY");
-    if (display && strlen(display) > 0) {
+    // Snapshot buffers the updater publishes into and the renderer draws from
+    if (!vis_snapshot_init(num_gangs)) {
+        fprintf(stderr, "Warning: Visualization will stay empty without snapshot buffers\n");
+    }
+    
+    // Gang states and expansion flags for the dashboards
+    if (!viewer_state_init(num_gangs)) {
+        perror("Failed to allocate memory for gang visualization states");
+        // Don't terminate, just log the error
+        fprintf(stderr, "Warning: Visualization will be limited due to memory allocation failure\n");
+    }
+    
+    // Check if we have a DISPLAY environment variable before trying OpenGL.
+    // Headless runs draw nothing themselves - attach crime_view instead.
+    char* display = headless ? NULL : getenv("DISPLAY");
+    if (headless) {
+        printf("Running headless, attach viewers with: crime_view --run-id=%d\n", ipc_run_id);
+    } else if (display && strlen(display) > 0) {
         printf("Display found (%s). Initializing OpenGL visualization...\n", display);
         // Initialize OpenGL visualization
         initialize_visualization(&argc, argv, &viz_context);
@@ -624,7 +857,7 @@ int main(int argc, char* argv[]) {
     
     // Create thread for visualization loop
     pthread_t viz_thread;
-    if (pthread_create(&viz_thread, NULL, visualization_thread_func, NULL) != 0) {
+    if (!headless && pthread_create(&viz_thread, NULL, visualization_thread_func, NULL) != 0) {
         perror("Failed to create visualization thread");
         fprintf(stderr, "Warning: Could not create visualization thread, continuing with text-only mode\n");
         // Don't terminate, continue with text-only mode
@@ -635,12 +868,7 @@ int main(int argc, char* argv[]) {
     usleep(200000);  // Increased to 200ms delay
     
     // Initialize gang states for visualization
-    viz_context.gang_states = (GangVisState*)malloc(num_gangs * sizeof(GangVisState));
-    if (viz_context.gang_states == NULL) {
-        perror("Failed to allocate memory for gang visualization states");
-        // Don't terminate, just log the error
-        fprintf(stderr, "Warning: Visualization will be limited due to memory allocation failure\n");
-    } else {
+    if (viz_context.gang_states != NULL) {
         printf("Allocated gang_states at %p for %d gangs\n", (void*)viz_context.gang_states, num_gangs);
     
         for (int i = 0; i < num_gangs; i++) {
@@ -650,52 +878,32 @@ int main(int argc, char* argv[]) {
             viz_context.gang_states[i].preparation_level = 0;
             viz_context.gang_states[i].current_target = BANK_ROBBERY; // Default
             
-            // Initialize with default members (will be updated later)
-            viz_context.gang_states[i].num_members = random_int(config.min_members_per_gang, config.max_members_per_gang);
-            viz_context.gang_states[i].num_agents = viz_context.gang_states[i].num_members / 3; // Estimate some agents
+            // Members and agents are filled in by ingestion once the gang publishes its record
+            viz_context.gang_states[i].num_members = 0;
+            viz_context.gang_states[i].num_agents = 0;
             viz_context.gang_states[i].is_active = true;
-            
-            printf("Initialized gang %d with %d members\n", i, viz_context.gang_states[i].num_members);
-            
-            // Create initial message queue for this gang
-            int prep_queue_id = msgget(REPORT_QUEUE_KEY + 1000 + i, IPC_CREAT | 0666);
-            if (prep_queue_id != -1) {
-                struct {
-                    long mtype;
-                    int preparation_level;
-                    CrimeType current_target;
-                    int num_members;
-                } prep_msg;
-                
-                prep_msg.mtype = 2; // Message type 2 for preparation updates
-                prep_msg.preparation_level = 0;
-                prep_msg.current_target = viz_context.gang_states[i].current_target;
-                prep_msg.num_members = viz_context.gang_states[i].num_members;
-                
-                msgsnd(prep_queue_id, &prep_msg, sizeof(prep_msg) - sizeof(long), IPC_NOWAIT);
-            }
         }
     }
     
     // Animation time
     viz_context.animation_time = 0.0f;
     
+    // First snapshot so the renderer has something to draw right away
+    visualization_publish_snapshot();
+    
     // No need to create another visualization thread, we already created one above
     
     // Thread health check variables
     int previous_health_count = 0;
     int health_check_failures = 0;
     
+    // One ingestion thread feeds whichever renderer runs; headless runs have none
+    if (!headless) {
+        ingest_start();
+    }
+    
     // Parent process main loop
     if (display && strlen(display) > 0) {
-        // In graphical mode, we need to run updates in a thread before glutMainLoop
-        pthread_t update_thread;
-        if (pthread_create(&update_thread, NULL, gang_state_update_thread, NULL) != 0) {
-            perror("Failed to create update thread");
-        } else {
-            pthread_detach(update_thread);
-        }
-        
         // In graphical mode, we need to run glutMainLoop in the main thread
         printf("Starting GLUT main loop in the main thread...\n");
         glutMainLoop();
@@ -705,10 +913,10 @@ int main(int argc, char* argv[]) {
         // Text-only mode, run the normal monitoring loop
         while (shared_state->simulation_running) {
             // Check visualization thread health every few iterations
-            pthread_mutex_lock(&viz_context.mutex);
+            sim_mutex_lock(&viz_context.mutex);
             int current_health = viz_context.viz_thread_health;
             bool thread_running = viz_context.viz_thread_running;
-            pthread_mutex_unlock(&viz_context.mutex);
+            sim_mutex_unlock(&viz_context.mutex);
             
             // Health checking logic from original code...
             if (thread_running && current_health == previous_health_count) {
@@ -720,18 +928,18 @@ int main(int argc, char* argv[]) {
                     printf("Visualization thread appears to be stuck, attempting recovery...\n");
                     
                     // Mark the thread as not running so it will exit if it's actually still active
-                    pthread_mutex_lock(&viz_context.mutex);
+                    sim_mutex_lock(&viz_context.mutex);
                     viz_context.simulation_running = false;
-                    pthread_mutex_unlock(&viz_context.mutex);
+                    sim_mutex_unlock(&viz_context.mutex);
                     
                     // Give it a moment to notice and exit
                     usleep(100000);
                     
                     // Now restart it by creating a new thread
-                    pthread_mutex_lock(&viz_context.mutex);
+                    sim_mutex_lock(&viz_context.mutex);
                     viz_context.simulation_running = true;
                     viz_context.viz_thread_running = false;
-                    pthread_mutex_unlock(&viz_context.mutex);
+                    sim_mutex_unlock(&viz_context.mutex);
                     
                     pthread_t viz_thread;
                     if (pthread_create(&viz_thread, NULL, visualization_thread_func, NULL) != 0) {
@@ -766,57 +974,10 @@ int main(int argc, char* argv[]) {
                 break;
             }
             
-            // Update gang visualization states from shared memory
-            for (int i = 0; i < num_gangs; i++) {
-                // Update arrest status
-                viz_context.gang_states[i].is_in_prison = shared_state->gang_status[i].is_arrested;
-                viz_context.gang_states[i].prison_time_remaining = shared_state->gang_status[i].prison_time;
-                
-                // Update preparation level - get this data through a message queue
-                int msg_queue_id = msgget(REPORT_QUEUE_KEY + 1000 + i, 0666);
-                if (msg_queue_id != -1) {
-                    // Try to receive an update message without blocking
-                    struct {
-                        long mtype;
-                        int preparation_level;
-                        CrimeType current_target;
-                        int num_members;
-                    } prep_msg;
-                    
-                    if (msgrcv(msg_queue_id, &prep_msg, sizeof(prep_msg) - sizeof(long), 2, IPC_NOWAIT) != -1) {
-                        // Update visualization if we received a message
-                        viz_context.gang_states[i].preparation_level = prep_msg.preparation_level;
-                        viz_context.gang_states[i].current_target = prep_msg.current_target;
-                        viz_context.gang_states[i].num_members = prep_msg.num_members;
-                        
-                        // Only print updates occasionally to avoid console spam
-                        static int update_count = 0;
-                        if (update_count++ % 10 == 0) {
-                            printf("Queue %d: Updated gang %d preparation: %d%%, target: %s, members: %d\n", 
-                                   msg_queue_id, i, prep_msg.preparation_level, 
-                                   crime_type_to_string(prep_msg.current_target), 
-                                   prep_msg.num_members);
-                        }
-                    } else {
-                        // Debug message when no message is available (print less frequently)
-                        static int no_message_count = 0;
-                        if (no_message_count++ % 100 == 0) {  // Reduced frequency to every 100th failure
-                            printf("No message available for gang %d in queue %d (errno: %d)\n", 
-                                   i, msg_queue_id, errno);
-                        }
-                    }
-                } else {
-                    // Only print occasionally to avoid console spam
-                    static int queue_fail_count = 0;
-                    if (queue_fail_count++ % 200 == 0) {  // Reduced frequency to every 200th failure
-                        printf("Failed to get message queue for gang %d (key: %d, errno: %d)\n", 
-                               i, REPORT_QUEUE_KEY + 1000 + i, errno);
-                    }
-                }
-            }
-            
             // Update animation time
+            sim_mutex_lock(&viz_context.mutex);
             viz_context.animation_time += 0.1f;
+            sim_mutex_unlock(&viz_context.mutex);
             
             // Sleep to avoid busy waiting
             usleep(500000); // 0.5 seconds
@@ -826,6 +987,20 @@ int main(int argc, char* argv[]) {
     // Set the flag to indicate simulation is stopping
     shared_state->simulation_running = false;
     
+    // Threaded runs wind down their gangs and police before the processes are signalled.
+    // The police goes first, then the report queue is closed.
+    if (ipc_mode == IPC_MODE_THREADS) {
+        for (int i = 0; i < num_police; i++) {
+            pthread_join(police_threads[i], NULL);
+            destroy_report_queue(report_queue_ids[i]);
+            report_queue_ids[i] = -1;
+        }
+        for (int i = 0; i < num_hosts; i++) {
+            pthread_join(host_threads[i], NULL);
+        }
+        outbox_stop();
+    }
+    
     // Signal all child processes to terminate
     signal_handler(SIGTERM);
     
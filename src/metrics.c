@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/shm.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/metrics.h"
+#include "../include/ipc.h"
+#include "../include/utils.h"
+
+// Registry of the current process - inherited by children across fork()
+MetricsRegistry* metrics_registry = NULL;
+
+// Histogram bucket upper bounds in microseconds (last bucket is +Inf)
+static const long long bucket_bounds_us[METRICS_HISTOGRAM_BUCKETS - 1] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+    50000, 100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+
+// Cleared by SIGINT/SIGTERM to stop the exporter loop
+static volatile sig_atomic_t exporter_running = 1;
+
+// Create the shared memory segment holding the metrics registry
+int create_metrics_registry() {
+    int shm_id = shmget(RUN_KEY(METRICS_SHM_KEY), sizeof(MetricsRegistry), IPC_CREAT | 0666);
+
+    if (shm_id == -1) {
+        perror("Failed to create metrics registry");
+        return -1;
+    }
+
+    // Start every run from zero, even if a stale segment was reused
+    MetricsRegistry* registry = attach_metrics_registry(shm_id);
+    if (registry != NULL) {
+        memset(registry, 0, sizeof(MetricsRegistry));
+        detach_metrics_registry(registry);
+    }
+
+    log_message("Created metrics registry with ID %d", shm_id);
+    return shm_id;
+}
+
+// Destroy the metrics registry segment
+void destroy_metrics_registry(int shm_id) {
+    if (shmctl(shm_id, IPC_RMID, NULL) == -1) {
+        perror("Failed to destroy metrics registry");
+    }
+    else {
+        log_message("Destroyed metrics registry with ID %d", shm_id);
+    }
+}
+
+// Attach to the metrics registry
+MetricsRegistry* attach_metrics_registry(int shm_id) {
+    MetricsRegistry* registry = (MetricsRegistry*)shmat(shm_id, NULL, 0);
+
+    if (registry == (MetricsRegistry*)-1) {
+        perror("Failed to attach to metrics registry");
+        return NULL;
+    }
+
+    return registry;
+}
+
+// Detach from the metrics registry
+void detach_metrics_registry(MetricsRegistry* registry) {
+    if (shmdt(registry) == -1) {
+        perror("Failed to detach from metrics registry");
+    }
+}
+
+// Record a duration in a histogram
+void metrics_observe_us(MetricHistogram* histogram, long long duration_us) {
+    int bucket = 0;
+    while (bucket < METRICS_HISTOGRAM_BUCKETS - 1 && duration_us > bucket_bounds_us[bucket]) {
+        bucket++;
+    }
+
+    atomic_fetch_add_explicit(&histogram->buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum_us, (unsigned long)duration_us, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+}
+
+// Record the duration of one gang main-loop iteration
+void metrics_observe_gang_tick(int gang_id, long long duration_us) {
+    if (metrics_registry == NULL || gang_id < 0 || gang_id >= METRICS_MAX_GANGS) {
+        return;
+    }
+
+    metrics_observe_us(&metrics_registry->gang_tick[gang_id], duration_us);
+}
+
+// Record how long a report waited in its lane (lanes are numbered from 1)
+void metrics_observe_report_latency(int lane, long long duration_us) {
+    if (metrics_registry == NULL || lane < 1 || lane > METRICS_REPORT_LANES) {
+        return;
+    }
+
+    metrics_observe_us(&metrics_registry->report_latency[lane - 1], duration_us);
+}
+
+// Record how long after it was sent the police decided on a report (lanes are numbered from 1)
+void metrics_observe_report_decision(int lane, long long duration_us) {
+    if (metrics_registry == NULL || lane < 1 || lane > METRICS_REPORT_LANES) {
+        return;
+    }
+
+    metrics_observe_us(&metrics_registry->report_decision_latency[lane - 1], duration_us);
+}
+
+// Record how long a task took from entering a police stage's queue to being handled
+void metrics_observe_police_stage(int stage, long long duration_us) {
+    if (metrics_registry == NULL || stage < 0 || stage >= METRICS_POLICE_STAGES) {
+        return;
+    }
+
+    metrics_observe_us(&metrics_registry->police_stage_latency[stage], duration_us);
+}
+
+// Read a counter or gauge
+static unsigned long counter_value(MetricCounter* counter) {
+    return atomic_load_explicit(&counter->value, memory_order_relaxed);
+}
+
+static long gauge_value(MetricGauge* gauge) {
+    return atomic_load_explicit(&gauge->value, memory_order_relaxed);
+}
+
+// Write a counter or gauge in Prometheus text format
+static void write_counter(FILE* out, const char* name, const char* help, unsigned long value) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s counter\n%s %lu\n", name, help, name, name, value);
+}
+
+static void write_gauge(FILE* out, const char* name, const char* help, double value) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s gauge\n%s %g\n", name, help, name, name, value);
+}
+
+// Write one labelled histogram series in Prometheus text format
+static void write_histogram_series(FILE* out, const char* name, const char* labels, MetricHistogram* histogram) {
+    unsigned long cumulative = 0;
+
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+        cumulative += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        if (i < METRICS_HISTOGRAM_BUCKETS - 1) {
+            fprintf(out, "%s_bucket{%s,le=\"%g\"} %lu\n", name, labels, bucket_bounds_us[i] / 1e6, cumulative);
+        }
+        else {
+            fprintf(out, "%s_bucket{%s,le=\"+Inf\"} %lu\n", name, labels, cumulative);
+        }
+    }
+
+    fprintf(out, "%s_sum{%s} %g\n", name, labels,
+            atomic_load_explicit(&histogram->sum_us, memory_order_relaxed) / 1e6);
+    fprintf(out, "%s_count{%s} %lu\n", name, labels,
+            atomic_load_explicit(&histogram->count, memory_order_relaxed));
+}
+
+// Previous sample of the counters the exporter turns into per-second rates
+typedef struct {
+    long long time_us;
+    unsigned long reports_received;
+    unsigned long missions;
+} RateSample;
+
+// Render the whole registry as Prometheus text; returns a malloc'ed string
+static char* render_metrics(MetricsRegistry* registry, RateSample* previous, size_t* length) {
+    char* text = NULL;
+    FILE* out = open_memstream(&text, length);
+    if (out == NULL) {
+        perror("Failed to open metrics buffer");
+        return NULL;
+    }
+
+    // Rates since the previous export
+    long long now = monotonic_time_us();
+    unsigned long reports_received = counter_value(&registry->reports_received);
+    unsigned long missions = counter_value(&registry->missions_succeeded) +
+                             counter_value(&registry->missions_failed);
+    double elapsed = previous->time_us > 0 ? (now - previous->time_us) / 1e6 : 0.0;
+    double reports_rate = elapsed > 0 ? (reports_received - previous->reports_received) / elapsed : 0.0;
+    double missions_rate = elapsed > 0 ? (missions - previous->missions) / elapsed : 0.0;
+    previous->time_us = now;
+    previous->reports_received = reports_received;
+    previous->missions = missions;
+
+    write_counter(out, "crime_sim_reports_sent_total", "Intelligence reports sent by agents",
+                  counter_value(&registry->reports_sent));
+    write_counter(out, "crime_sim_reports_failed_total", "Intelligence reports agents failed to send",
+                  counter_value(&registry->reports_failed));
+    write_counter(out, "crime_sim_reports_coalesced_total", "Reports merged into a newer one before sending",
+                  counter_value(&registry->reports_coalesced));
+    write_counter(out, "crime_sim_reports_received_total", "Intelligence reports received by police",
+                  reports_received);
+    write_gauge(out, "crime_sim_reports_per_second", "Reports received by police per second",
+                reports_rate);
+    write_gauge(out, "crime_sim_report_queue_depth", "Messages waiting in the report queue",
+                gauge_value(&registry->report_queue_depth));
+
+    static const char* lane_names[METRICS_REPORT_LANES] = {"urgent", "priority", "routine"};
+    fprintf(out, "# HELP crime_sim_report_latency_seconds Time a report waited in the report queue, by lane\n");
+    fprintf(out, "# TYPE crime_sim_report_latency_seconds histogram\n");
+    for (int lane = 0; lane < METRICS_REPORT_LANES; lane++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "lane=\"%s\"", lane_names[lane]);
+        write_histogram_series(out, "crime_sim_report_latency_seconds", labels, &registry->report_latency[lane]);
+    }
+    fprintf(out, "# HELP crime_sim_report_decision_latency_seconds Time from sending a report to the police deciding on it, by lane\n");
+    fprintf(out, "# TYPE crime_sim_report_decision_latency_seconds histogram\n");
+    for (int lane = 0; lane < METRICS_REPORT_LANES; lane++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "lane=\"%s\"", lane_names[lane]);
+        write_histogram_series(out, "crime_sim_report_decision_latency_seconds", labels,
+                               &registry->report_decision_latency[lane]);
+    }
+
+    fprintf(out, "# HELP crime_sim_police_decisions_total Police action decisions by outcome\n");
+    fprintf(out, "# TYPE crime_sim_police_decisions_total counter\n");
+    fprintf(out, "crime_sim_police_decisions_total{outcome=\"act\"} %lu\n",
+            counter_value(&registry->decisions_act));
+    fprintf(out, "crime_sim_police_decisions_total{outcome=\"hold\"} %lu\n",
+            counter_value(&registry->decisions_hold));
+    write_counter(out, "crime_sim_arrests_total", "Gang arrests made by police",
+                  counter_value(&registry->arrests));
+    write_gauge(out, "crime_sim_police_backlog", "Reports held by police awaiting a decision",
+                gauge_value(&registry->police_backlog));
+
+    static const char* stage_names[METRICS_POLICE_STAGES] = {"aggregation", "decision", "arrest"};
+    fprintf(out, "# HELP crime_sim_police_stage_depth Tasks waiting in the queue of a police stage\n");
+    fprintf(out, "# TYPE crime_sim_police_stage_depth gauge\n");
+    for (int stage = 0; stage < METRICS_POLICE_STAGES; stage++) {
+        fprintf(out, "crime_sim_police_stage_depth{stage=\"%s\"} %ld\n", stage_names[stage],
+                gauge_value(&registry->police_stage_depth[stage]));
+    }
+    fprintf(out, "# HELP crime_sim_police_stage_latency_seconds Time from entering a police stage's queue to being handled\n");
+    fprintf(out, "# TYPE crime_sim_police_stage_latency_seconds histogram\n");
+    for (int stage = 0; stage < METRICS_POLICE_STAGES; stage++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", stage_names[stage]);
+        write_histogram_series(out, "crime_sim_police_stage_latency_seconds", labels,
+                               &registry->police_stage_latency[stage]);
+    }
+
+    fprintf(out, "# HELP crime_sim_missions_total Gang missions by outcome\n");
+    fprintf(out, "# TYPE crime_sim_missions_total counter\n");
+    fprintf(out, "crime_sim_missions_total{outcome=\"success\"} %lu\n",
+            counter_value(&registry->missions_succeeded));
+    fprintf(out, "crime_sim_missions_total{outcome=\"failure\"} %lu\n",
+            counter_value(&registry->missions_failed));
+    write_gauge(out, "crime_sim_missions_per_second", "Missions executed per second", missions_rate);
+    write_counter(out, "crime_sim_agents_executed_total", "Secret agents executed by gangs",
+                  counter_value(&registry->agents_executed));
+
+    // Per-gang tick time histograms
+    long num_gangs = gauge_value(&registry->num_gangs);
+    if (num_gangs > METRICS_MAX_GANGS) num_gangs = METRICS_MAX_GANGS;
+    fprintf(out, "# HELP crime_sim_gang_tick_seconds Work time of one gang main-loop iteration\n");
+    fprintf(out, "# TYPE crime_sim_gang_tick_seconds histogram\n");
+    for (int i = 0; i < num_gangs; i++) {
+        char labels[32];
+        snprintf(labels, sizeof(labels), "gang=\"%d\"", i);
+        write_histogram_series(out, "crime_sim_gang_tick_seconds", labels, &registry->gang_tick[i]);
+    }
+
+    fprintf(out, "# HELP crime_sim_ingest_tick_seconds Time of one dashboard ingestion pass over all gangs\n");
+    fprintf(out, "# TYPE crime_sim_ingest_tick_seconds histogram\n");
+    write_histogram_series(out, "crime_sim_ingest_tick_seconds", "process=\"coordinator\"", &registry->ingest_tick);
+    write_counter(out, "crime_sim_snapshots_published_total", "Dashboard snapshots published by ingestion",
+                  counter_value(&registry->snapshots_published));
+
+    write_counter(out, "crime_sim_scratch_allocations_avoided_total",
+                  "Arena and pool allocations served without the heap",
+                  counter_value(&registry->scratch_allocations_avoided));
+    write_counter(out, "crime_sim_scratch_heap_allocations_total",
+                  "Heap allocations made by arenas and pools",
+                  counter_value(&registry->scratch_heap_allocations));
+
+    fclose(out);
+    return text;
+}
+
+// Replace the metrics file atomically so scrapers never see a partial file
+static void write_metrics_file(const char* path, const char* text, size_t length) {
+    char tmp_path[300];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE* file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        perror("Failed to open metrics file");
+        return;
+    }
+
+    fwrite(text, 1, length, file);
+    fclose(file);
+
+    if (rename(tmp_path, path) == -1) {
+        perror("Failed to publish metrics file");
+    }
+}
+
+// Create the listening unix socket the metrics are served on
+static int open_metrics_socket(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("Failed to create metrics socket");
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    // Remove a socket left behind by a previous run
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        perror("Failed to bind metrics socket");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Answer one client with the most recent export
+static void serve_metrics_client(int listen_fd, const char* text, size_t length) {
+    int client_fd = accept(listen_fd, NULL, NULL);
+    if (client_fd == -1) {
+        return;
+    }
+
+    size_t written = 0;
+    while (text != NULL && written < length) {
+        ssize_t result = write(client_fd, text + written, length - written);
+        if (result <= 0) break;
+        written += result;
+    }
+
+    close(client_fd);
+}
+
+static void exporter_signal_handler(int sig) {
+    exporter_running = 0;
+}
+
+// Metrics exporter process main function
+void run_metrics_exporter(SimulationConfig config, const int* report_queue_ids) {
+    signal(SIGINT, exporter_signal_handler);
+    signal(SIGTERM, exporter_signal_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (metrics_registry == NULL) {
+        fprintf(stderr, "Metrics registry not available, exporter exiting\n");
+        exit(1);
+    }
+
+    int listen_fd = open_metrics_socket(config.metrics_socket);
+    log_message("Metrics exporter writing %s every %d ms, serving %s",
+                config.metrics_file, config.metrics_interval_ms, config.metrics_socket);
+
+    RateSample previous = {0};
+    char* text = NULL;
+    size_t length = 0;
+    long long next_export = 0;
+
+    while (exporter_running) {
+        long long now = monotonic_time_us();
+
+        if (now >= next_export) {
+            // Sample the queue depth here so producers and consumers never pay for it
+            if (report_queue_ids != NULL) {
+                long depth = 0;
+                for (int p = 0; p < report_partitions; p++) {
+                    struct msqid_ds queue_info;
+                    if (msgctl(report_queue_ids[p], IPC_STAT, &queue_info) == 0) {
+                        depth += (long)queue_info.msg_qnum;
+                    }
+                }
+                METRICS_SET(report_queue_depth, depth);
+            }
+
+            free(text);
+            text = render_metrics(metrics_registry, &previous, &length);
+            if (text != NULL) {
+                write_metrics_file(config.metrics_file, text, length);
+            }
+            next_export = now + config.metrics_interval_ms * 1000LL;
+        }
+
+        int timeout_ms = (int)((next_export - now) / 1000);
+        if (timeout_ms < 0) timeout_ms = 0;
+
+        if (listen_fd != -1) {
+            struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+            if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN)) {
+                serve_metrics_client(listen_fd, text, length);
+            }
+        }
+        else {
+            delay_ms(timeout_ms);
+        }
+    }
+
+    // Cleanup
+    if (listen_fd != -1) {
+        close(listen_fd);
+        unlink(config.metrics_socket);
+    }
+    free(text);
+    detach_metrics_registry(metrics_registry);
+    exit(0);
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include "../include/outbox.h"
+#include "../include/ipc.h"
+#include "../include/utils.h"
+#include "../include/metrics.h"
+
+// A posted report with the mission it is about
+typedef struct {
+    IntelligenceReport report;
+    unsigned int mission;
+} OutboxEntry;
+
+// Same lock-free ring as a member's tip mailbox: agents of every gang post,
+// only the sender thread takes
+typedef struct {
+    atomic_uint sequence;
+    OutboxEntry entry;
+} OutboxCell;
+
+static OutboxCell cells[OUTBOX_CAPACITY];
+static atomic_uint outbox_tail;
+static unsigned int outbox_head;        // Sender thread only
+
+// Reports taken from the ring but not sent yet, one per agent and mission, oldest first
+static OutboxEntry pending[OUTBOX_MAX_PENDING];
+static int num_pending = 0;
+
+// Sender thread
+static pthread_t sender_thread;
+static pthread_mutex_t sender_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sender_cond = PTHREAD_COND_INITIALIZER;
+static bool sender_running = false;
+static int sender_queue_ids[MAX_REPORT_PARTITIONS];    // One per report queue partition
+static int sender_flush_ms = 1;
+
+// Totals for the summary logged by outbox_stop
+static atomic_uint reports_posted;
+static atomic_uint reports_dropped;
+static unsigned int reports_coalesced;  // Sender thread only
+static unsigned int reports_flushed;    // Sender thread only
+static unsigned int reports_lost;       // Sender thread only, refused by a removed queue
+
+// Reports that reached the police, per gang - posts coalesced away never count
+static atomic_uint reports_sent_by_gang[OUTBOX_MAX_GANGS];
+
+// Queue a report for the police (any thread, never blocks). False, and the
+// report lost, when the outbox is full.
+bool outbox_post(IntelligenceReport report, unsigned int mission) {
+    unsigned int position = atomic_load_explicit(&outbox_tail, memory_order_relaxed);
+    OutboxCell* cell;
+    for (;;) {
+        cell = &cells[position & (OUTBOX_CAPACITY - 1)];
+        unsigned int sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int difference = (int)(sequence - position);
+
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&outbox_tail, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            // The sender has fallen a full ring behind
+            atomic_fetch_add_explicit(&reports_dropped, 1, memory_order_relaxed);
+            METRICS_INC(reports_failed);
+            return false;
+        }
+        else {
+            position = atomic_load_explicit(&outbox_tail, memory_order_relaxed);
+        }
+    }
+
+    cell->entry.report = report;
+    cell->entry.mission = mission;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    atomic_fetch_add_explicit(&reports_posted, 1, memory_order_relaxed);
+    return true;
+}
+
+// Take the oldest posted report (sender thread). False when the ring is empty.
+static bool outbox_take(OutboxEntry* entry) {
+    OutboxCell* cell = &cells[outbox_head & (OUTBOX_CAPACITY - 1)];
+    unsigned int sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if ((int)(sequence - (outbox_head + 1)) < 0) {
+        return false;
+    }
+
+    *entry = cell->entry;
+    atomic_store_explicit(&cell->sequence, outbox_head + OUTBOX_CAPACITY, memory_order_release);
+    outbox_head++;
+    return true;
+}
+
+// Move the posted reports into the pending batch. A report replaces the
+// pending one of the same agent about the same mission.
+static void drain_outbox() {
+    OutboxEntry entry;
+    while (num_pending < OUTBOX_MAX_PENDING && outbox_take(&entry)) {
+        int i;
+        for (i = 0; i < num_pending; i++) {
+            if (pending[i].mission == entry.mission &&
+                pending[i].report.gang_id == entry.report.gang_id &&
+                pending[i].report.agent_id == entry.report.agent_id) {
+                break;
+            }
+        }
+
+        if (i < num_pending) {
+            pending[i].report = entry.report;
+            reports_coalesced++;
+            METRICS_INC(reports_coalesced);
+        } else {
+            pending[num_pending++] = entry;
+        }
+    }
+}
+
+// Send the pending batch to the report queue partitions, most urgent lane
+// first and oldest first within a lane, until a partition is full
+static void flush_pending() {
+    // Stable insertion sort by lane - batches are small
+    for (int i = 1; i < num_pending; i++) {
+        OutboxEntry entry = pending[i];
+        int lane = report_lane(entry.report);
+        int j = i - 1;
+        while (j >= 0 && report_lane(pending[j].report) > lane) {
+            pending[j + 1] = pending[j];
+            j--;
+        }
+        pending[j + 1] = entry;
+    }
+
+    // A full partition keeps its reports for the next flush without holding up the others
+    bool full[MAX_REPORT_PARTITIONS] = {false};
+    int sent = 0;
+    int kept = 0;
+    for (int i = 0; i < num_pending; i++) {
+        int partition = report_partition(pending[i].report.gang_id);
+        if (!full[partition]) {
+            IntelligenceReport* report = &pending[i].report;
+            if (send_report(sender_queue_ids[partition], *report) != -1) {
+                if (report->gang_id >= 0 && report->gang_id < OUTBOX_MAX_GANGS) {
+                    atomic_fetch_add_explicit(&reports_sent_by_gang[report->gang_id], 1, memory_order_relaxed);
+                }
+                log_message("Agent %d in gang %d submitted a report with suspicion level %d",
+                            report->agent_id, report->gang_id, report->suspicion_level);
+                sent++;
+                continue;
+            }
+            if (errno != EAGAIN) {
+                // Lost with the queue
+                reports_lost++;
+                continue;
+            }
+            full[partition] = true;
+        }
+        pending[kept++] = pending[i];
+    }
+
+    reports_flushed += sent;
+    num_pending = kept;
+}
+
+// Sender thread: drain and flush every flush interval, and once more when stopped
+static void* sender_routine(void* arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&sender_mutex);
+    while (sender_running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += sender_flush_ms / 1000;
+        deadline.tv_nsec += (sender_flush_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (sender_running) {
+            if (pthread_cond_timedwait(&sender_cond, &sender_mutex, &deadline) != 0) break;
+        }
+        pthread_mutex_unlock(&sender_mutex);
+
+        drain_outbox();
+        flush_pending();
+
+        pthread_mutex_lock(&sender_mutex);
+    }
+    pthread_mutex_unlock(&sender_mutex);
+
+    drain_outbox();
+    flush_pending();
+    return NULL;
+}
+
+// Open this process's outbox for the report queue partitions and start its sender thread
+bool outbox_start(const int* report_queue_ids, int flush_ms) {
+    for (unsigned int i = 0; i < OUTBOX_CAPACITY; i++) {
+        atomic_init(&cells[i].sequence, i);
+    }
+    atomic_init(&outbox_tail, 0);
+    outbox_head = 0;
+    num_pending = 0;
+    atomic_init(&reports_posted, 0);
+    atomic_init(&reports_dropped, 0);
+    reports_coalesced = 0;
+    reports_flushed = 0;
+    reports_lost = 0;
+    for (int i = 0; i < OUTBOX_MAX_GANGS; i++) {
+        atomic_init(&reports_sent_by_gang[i], 0);
+    }
+
+    memcpy(sender_queue_ids, report_queue_ids, report_partitions * sizeof(int));
+    sender_flush_ms = flush_ms > 0 ? flush_ms : 1;
+    sender_running = true;
+    if (pthread_create(&sender_thread, NULL, sender_routine, NULL) != 0) {
+        perror("Failed to create outbox sender thread");
+        sender_running = false;
+        return false;
+    }
+    return true;
+}
+
+// Flush what is left, stop the sender thread and log the outbox totals
+void outbox_stop() {
+    pthread_mutex_lock(&sender_mutex);
+    bool running = sender_running;
+    sender_running = false;
+    pthread_cond_signal(&sender_cond);
+    pthread_mutex_unlock(&sender_mutex);
+    if (!running) return;
+
+    pthread_join(sender_thread, NULL);
+
+    log_message("Outbox: %u reports posted, %u coalesced, %u sent, %u lost, %u dropped, %d unsent",
+                atomic_load(&reports_posted), reports_coalesced, reports_flushed, reports_lost,
+                atomic_load(&reports_dropped), num_pending);
+}
+
+// Reports of a gang's agents the sender thread has sent to the police so far
+unsigned int outbox_reports_sent(int gang_id) {
+    if (gang_id < 0 || gang_id >= OUTBOX_MAX_GANGS) return 0;
+    return atomic_load_explicit(&reports_sent_by_gang[gang_id], memory_order_relaxed);
+}
@@ -0,0 +1,255 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "../include/placement.h"
+#include "../include/utils.h"
+
+// Largest NUMA node id placement handles (one bit each in a node mask)
+#define MAX_PLACEMENT_NODES 64
+
+// CPUs in placement order; empty when placement is off
+static int placement_cpus[CPU_SETSIZE];
+static int num_placement_cpus = 0;
+
+// CPUs after the first that are reserved for the police; the gang hosts get the rest
+static int num_police_cpus = 1;
+
+// NUMA node of a CPU, from the nodeN entry in its sysfs directory (0 if unknown)
+int placement_node_of_cpu(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR* dir = opendir(path);
+    if (dir == NULL) return 0;
+
+    int node = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && isdigit((unsigned char)entry->d_name[4])) {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+// Parse a cpu list such as "0-3,8" into placement_cpus; false if malformed
+static bool parse_cpu_list(const char* list, const cpu_set_t* allowed) {
+    const char* p = list;
+    while (*p) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) return false;
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) return false;
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) return false;
+
+        for (long cpu = first; cpu <= last; cpu++) {
+            if (!CPU_ISSET(cpu, allowed)) {
+                fprintf(stderr, "Placement: CPU %ld is not available to this process, skipped\n", cpu);
+                continue;
+            }
+            if (num_placement_cpus < CPU_SETSIZE) {
+                placement_cpus[num_placement_cpus++] = (int)cpu;
+            }
+        }
+
+        p = end;
+        if (*p == ',') p++;
+        else if (*p != '\0') return false;
+    }
+    return true;
+}
+
+// Order the allowed CPUs by node (compact) or alternating between nodes (spread)
+static void order_cpus(const cpu_set_t* allowed, bool spread) {
+    static int cpu_node[CPU_SETSIZE];
+    int max_node = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, allowed)) continue;
+        cpu_node[cpu] = placement_node_of_cpu(cpu);
+        if (cpu_node[cpu] > max_node) max_node = cpu_node[cpu];
+    }
+
+    if (!spread) {
+        for (int node = 0; node <= max_node; node++) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, allowed) && cpu_node[cpu] == node) {
+                    placement_cpus[num_placement_cpus++] = cpu;
+                }
+            }
+        }
+        return;
+    }
+
+    // Spread: the next unused CPU of every node in turn
+    int total = CPU_COUNT(allowed);
+    int* next_cpu = (int*)calloc(max_node + 1, sizeof(int));
+    if (next_cpu == NULL) return;
+    while (num_placement_cpus < total) {
+        for (int node = 0; node <= max_node; node++) {
+            while (next_cpu[node] < CPU_SETSIZE &&
+                   !(CPU_ISSET(next_cpu[node], allowed) && cpu_node[next_cpu[node]] == node)) {
+                next_cpu[node]++;
+            }
+            if (next_cpu[node] < CPU_SETSIZE) {
+                placement_cpus[num_placement_cpus++] = next_cpu[node]++;
+            }
+        }
+    }
+    free(next_cpu);
+}
+
+// Build the CPU list for a placement policy; false (and no pinning) if the policy is invalid
+bool placement_init(const char* policy) {
+    num_placement_cpus = 0;
+    num_police_cpus = 1;
+    if (policy == NULL || policy[0] == '\0' || strcmp(policy, "none") == 0) {
+        return true;
+    }
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        perror("Failed to read CPU affinity");
+        return false;
+    }
+
+    if (strcmp(policy, "compact") == 0) {
+        order_cpus(&allowed, false);
+    }
+    else if (strcmp(policy, "spread") == 0) {
+        order_cpus(&allowed, true);
+    }
+    else if (!parse_cpu_list(policy, &allowed)) {
+        fprintf(stderr, "Invalid placement '%s' (none, compact, spread or a cpu list like 0-3,8)\n", policy);
+        num_placement_cpus = 0;
+        return false;
+    }
+
+    if (num_placement_cpus == 0) {
+        fprintf(stderr, "Placement '%s' left no usable CPU, not pinning\n", policy);
+        return false;
+    }
+
+    log_message("Placement '%s' over %d CPUs: viewer on CPU %d",
+                policy, num_placement_cpus, placement_cpu(PLACEMENT_ROLE_VIEWER, 0));
+    return true;
+}
+
+// Reserve the CPUs after the first for the police: `threads` per police process,
+// or by default half of them (at least one per process). At least one CPU is
+// always left to the gang hosts. Must be called before any gang host is placed.
+void placement_reserve_police(int processes, int threads) {
+    if (num_placement_cpus == 0) return;
+
+    int wanted = threads > 0 ? processes * threads : (num_placement_cpus - 1) / 2;
+    if (wanted < processes) wanted = processes;
+
+    int available = num_placement_cpus - 2;
+    if (wanted > available) wanted = available;
+    if (wanted < 1) wanted = 1;
+    num_police_cpus = wanted;
+
+    log_message("Placement: police on %d CPU(s) from CPU %d, gang hosts from CPU %d",
+                num_police_cpus, placement_cpu(PLACEMENT_ROLE_POLICE, 0),
+                placement_cpu(PLACEMENT_ROLE_GANG_HOST, 0));
+}
+
+// Whether a placement policy is pinning anything
+bool placement_enabled() {
+    return num_placement_cpus > 0;
+}
+
+// CPU for the index-th instance of a role, -1 without placement
+int placement_cpu(PlacementRole role, int index) {
+    if (num_placement_cpus == 0) return -1;
+
+    int first_gang_cpu = 1 + num_police_cpus;
+
+    switch (role) {
+        case PLACEMENT_ROLE_VIEWER:
+            return placement_cpus[0];
+        case PLACEMENT_ROLE_POLICE:
+        case PLACEMENT_ROLE_POLICE_WORKER:
+            return placement_cpus[(1 + index % num_police_cpus) % num_placement_cpus];
+        case PLACEMENT_ROLE_GANG_HOST:
+        default:
+            if (num_placement_cpus > first_gang_cpu) {
+                return placement_cpus[first_gang_cpu + index % (num_placement_cpus - first_gang_cpu)];
+            }
+            return placement_cpus[(first_gang_cpu + index) % num_placement_cpus];
+    }
+}
+
+// Number of distinct CPUs the instances of a role are spread over, 0 without placement
+int placement_role_cpus(PlacementRole role) {
+    if (num_placement_cpus == 0) return 0;
+
+    switch (role) {
+        case PLACEMENT_ROLE_VIEWER:
+            return 1;
+        case PLACEMENT_ROLE_POLICE:
+        case PLACEMENT_ROLE_POLICE_WORKER:
+            return num_placement_cpus > 1 ? num_police_cpus : 1;
+        case PLACEMENT_ROLE_GANG_HOST:
+        default:
+            return num_placement_cpus > 1 + num_police_cpus ? num_placement_cpus - 1 - num_police_cpus : num_placement_cpus;
+    }
+}
+
+// Pin the calling thread to its role's CPU; threads it creates afterwards inherit it
+void placement_pin_thread(PlacementRole role, int index) {
+    int cpu = placement_cpu(role, index);
+    if (cpu < 0) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+        perror("Failed to pin thread");
+    }
+}
+
+// Place a shared segment on the NUMA node(s) of its main writers - the first
+// `count` instances of `role` - and move the pages already touched there.
+// Several nodes get the segment interleaved over them.
+void placement_bind_memory(void* addr, size_t length, PlacementRole role, int count) {
+    if (num_placement_cpus == 0 || count <= 0) return;
+
+    unsigned long nodes = 0;
+    for (int i = 0; i < count; i++) {
+        int node = placement_node_of_cpu(placement_cpu(role, i));
+        if (node < MAX_PLACEMENT_NODES) {
+            nodes |= 1UL << node;
+        }
+    }
+    if (nodes == 0) return;
+
+    // Single node: prefer it. Several: interleave.
+    int mode = (nodes & (nodes - 1)) == 0 ? MPOL_PREFERRED : MPOL_INTERLEAVE;
+
+    // mbind wants a page-aligned range
+    long page = sysconf(_SC_PAGESIZE);
+    unsigned long start = (unsigned long)addr & ~(page - 1);
+    unsigned long end = ((unsigned long)addr + length + page - 1) & ~(page - 1);
+
+    if (syscall(SYS_mbind, start, end - start, mode, &nodes, MAX_PLACEMENT_NODES + 1, MPOL_MF_MOVE) == -1) {
+        // Kernels without NUMA support refuse; placement then stays with the kernel
+        if (errno != ENOSYS && errno != EPERM) {
+            perror("Failed to bind shared memory to NUMA node");
+        }
+    }
+}
@@ -3,293 +3,609 @@
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <time.h>
+#include <errno.h>
 #include "../include/police.h"
 #include "../include/utils.h"
 #include "../include/ipc.h"
 #include "../include/config.h"
+#include "../include/metrics.h"
+#include "../include/lock_profile.h"
+#include "../include/placement.h"
 
-// Initialize police
-void initialize_police(Police* police, SimulationConfig config) {
-    // Initialize report storage
-    police->report_capacity = 100;
-    police->reports = (IntelligenceReport*)malloc(police->report_capacity * sizeof(IntelligenceReport));
-    police->num_reports = 0;
+// How long an idle decision or arrest thread sleeps before checking whether the police stopped
+#define POLICE_STAGE_IDLE_US 100000
+
+// Index of a lane's ring, from its lane number (anything out of range counts as routine)
+static int lane_index(int lane) {
+    if (lane < 1 || lane > POLICE_LANES) return POLICE_LANES - 1;
+    return lane - 1;
+}
+
+// Set up an empty queue feeding a stage
+static void police_queue_init(PoliceQueue* queue, PoliceStage stage) {
+    for (int lane = 0; lane < POLICE_LANES; lane++) {
+        PoliceRing* ring = &queue->lanes[lane];
+        for (unsigned int i = 0; i < POLICE_QUEUE_CAPACITY; i++) {
+            atomic_init(&ring->cells[i].sequence, i);
+        }
+        atomic_init(&ring->tail, 0);
+        ring->head = 0;
+    }
+    sem_init(&queue->ready, 0, 0);
+    queue->stage = stage;
+}
+
+// Queue a task on its lane of a stage queue (any thread). False while that lane is full.
+static bool police_queue_push(PoliceQueue* queue, PoliceTask task) {
+    PoliceRing* ring = &queue->lanes[lane_index(task.lane)];
+    unsigned int position = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    for (;;) {
+        unsigned int sequence = atomic_load_explicit(&ring->cells[position % POLICE_QUEUE_CAPACITY].sequence,
+                                                     memory_order_acquire);
+        int difference = (int)(sequence - position);
+        
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            return false;
+        }
+        else {
+            position = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+    
+    task.queued_us = monotonic_time_us();
+    ring->cells[position % POLICE_QUEUE_CAPACITY].task = task;
+    atomic_store_explicit(&ring->cells[position % POLICE_QUEUE_CAPACITY].sequence, position + 1,
+                          memory_order_release);
+    METRICS_ADD(police_stage_depth[queue->stage], 1);
+    sem_post(&queue->ready);
+    return true;
+}
+
+// Take the oldest task of the most urgent lane that has one (the stage's
+// thread only). False when every lane is empty.
+static bool police_queue_pop(PoliceQueue* queue, PoliceTask* task) {
+    for (int lane = 0; lane < POLICE_LANES; lane++) {
+        PoliceRing* ring = &queue->lanes[lane];
+        unsigned int head = ring->head;
+        unsigned int sequence = atomic_load_explicit(&ring->cells[head % POLICE_QUEUE_CAPACITY].sequence,
+                                                     memory_order_acquire);
+        if ((int)(sequence - (head + 1)) < 0) {
+            continue;
+        }
+        
+        *task = ring->cells[head % POLICE_QUEUE_CAPACITY].task;
+        atomic_store_explicit(&ring->cells[head % POLICE_QUEUE_CAPACITY].sequence, head + POLICE_QUEUE_CAPACITY,
+                              memory_order_release);
+        ring->head = head + 1;
+        METRICS_ADD(police_stage_depth[queue->stage], -1);
+        return true;
+    }
+    return false;
+}
+
+// Hand a task to the next stage, waiting while that stage is backed up
+static void pass_on(Police* police, PoliceQueue* queue, PoliceTask task) {
+    while (!police_queue_push(queue, task) && atomic_load(&police->running)) {
+        usleep(1000);
+    }
+}
+
+// Wait up to wait_us for a stage's semaphore to be posted
+static void wait_for_work(sem_t* ready, long long wait_us) {
+    if (wait_us <= 0) return;
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += wait_us / 1000000;
+    deadline.tv_nsec += (wait_us % 1000000) * 1000;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(ready, &deadline) == -1 && errno == EINTR) {
+    }
+}
+
+// Initialize police and start the threads of every pipeline stage
+bool initialize_police(Police* police, int partition, int num_shards, SimulationConfig config) {
+    if (num_shards < 1) num_shards = 1;
     
     // Initialize statistics
-    police->thwarted_missions = 0;
-    police->total_agents = 0;
-    police->lost_agents = 0;
+    atomic_init(&police->thwarted_missions, 0);
+    atomic_init(&police->total_agents, 0);
+    atomic_init(&police->lost_agents, 0);
+    atomic_init(&police->backlog, 0);
+    atomic_init(&police->running, true);
+    police->config = config;
+    police->partition = partition;
+    police->shm = NULL;
+    police->sem_id = -1;
+    
+    police->shards = (PoliceShard*)calloc(num_shards, sizeof(PoliceShard));
+    if (police->shards == NULL) {
+        perror("Failed to allocate police shards");
+        return false;
+    }
+    police->num_shards = num_shards;
+    
+    for (int i = 0; i < num_shards; i++) {
+        PoliceShard* shard = &police->shards[i];
+        shard->index = i;
+        shard->police = police;
+        
+        // Initialize report storage
+        for (int lane = 0; lane < POLICE_LANES; lane++) {
+            atomic_init(&shard->inbox_head[lane], 0);
+            atomic_init(&shard->inbox_tail[lane], 0);
+        }
+        sem_init(&shard->inbox_ready, 0, 0);
+        for (int word = 0; word < (POLICE_MAX_GANGS + 63) / 64; word++) {
+            atomic_init(&shard->clear_gangs[word], 0);
+        }
+        pool_init(&shard->report_pool, sizeof(StoredReport), REPORT_POOL_SLAB);
+        shard->reports = NULL;
+        shard->last_report = NULL;
+        shard->num_reports = 0;
+        shard->sweeps = 0;
+    }
+    
+    police_queue_init(&police->decisions, POLICE_STAGE_DECISION);
+    police_queue_init(&police->arrests, POLICE_STAGE_ARREST);
+    
+    // Later stages first, so every stage has somewhere to pass its tasks on to
+    if (pthread_create(&police->arrest_thread, NULL, police_arrest_routine, police) != 0) {
+        perror("Failed to create police arrest thread");
+        return false;
+    }
+    if (pthread_create(&police->decision_thread, NULL, police_decision_routine, police) != 0) {
+        perror("Failed to create police decision thread");
+        atomic_store(&police->running, false);
+        pthread_join(police->arrest_thread, NULL);
+        return false;
+    }
+    for (int i = 0; i < num_shards; i++) {
+        if (pthread_create(&police->shards[i].thread, NULL, police_shard_routine, &police->shards[i]) != 0) {
+            perror("Failed to create police shard thread");
+            police->num_shards = i;
+            stop_police(police);
+            return false;
+        }
+    }
+    
+    log_message("Police force initialized with %d shards", num_shards);
+    return true;
+}
+
+// Change a shard's report count and publish the backlog of all shards
+static void update_backlog(PoliceShard* shard, int change) {
+    shard->num_reports += change;
+    int backlog = atomic_fetch_add_explicit(&shard->police->backlog, change, memory_order_relaxed) + change;
+    METRICS_SET(police_backlog, backlog);
+}
+
+// Hand a report to its lane of the inbox of the shard owning its gang
+// (ingestion thread only). False while that lane is full.
+bool route_intelligence(Police* police, IntelligenceReport report, long long sent_us) {
+    int gang_id = report.gang_id < 0 ? 0 : report.gang_id;
+    PoliceShard* shard = &police->shards[gang_id % police->num_shards];
+    int lane = report_lane(report);
+    int index = lane_index(lane);
     
-    // Initialize synchronization
-    pthread_mutex_init(&police->police_mutex, NULL);
-    pthread_cond_init(&police->police_cond, NULL);
+    unsigned int tail = atomic_load_explicit(&shard->inbox_tail[index], memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&shard->inbox_head[index], memory_order_acquire);
+    if (tail - head == POLICE_SHARD_INBOX) {
+        return false;
+    }
     
-    log_message("Police force initialized");
+    RoutedReport* routed = &shard->inbox[index][tail % POLICE_SHARD_INBOX];
+    routed->report = report;
+    routed->lane = lane;
+    routed->sent_us = sent_us;
+    routed->queued_us = monotonic_time_us();
+    atomic_store_explicit(&shard->inbox_tail[index], tail + 1, memory_order_release);
+    METRICS_ADD(police_stage_depth[POLICE_STAGE_AGGREGATION], 1);
+    sem_post(&shard->inbox_ready);
+    return true;
 }
 
-// Process intelligence report
-void process_intelligence(Police* police, IntelligenceReport report, SimulationConfig config) {
-    pthread_mutex_lock(&police->police_mutex);
+// Take the oldest report of the most urgent inbox lane that has one (shard thread only)
+static bool take_intelligence(PoliceShard* shard, RoutedReport* routed) {
+    for (int lane = 0; lane < POLICE_LANES; lane++) {
+        unsigned int head = atomic_load_explicit(&shard->inbox_head[lane], memory_order_relaxed);
+        unsigned int tail = atomic_load_explicit(&shard->inbox_tail[lane], memory_order_acquire);
+        if (head == tail) {
+            continue;
+        }
+        
+        *routed = shard->inbox[lane][head % POLICE_SHARD_INBOX];
+        atomic_store_explicit(&shard->inbox_head[lane], head + 1, memory_order_release);
+        METRICS_ADD(police_stage_depth[POLICE_STAGE_AGGREGATION], -1);
+        return true;
+    }
+    return false;
+}
+
+// Return the reports about a gang (-1: every report) to the shard's report pool
+static void discard_reports(PoliceShard* shard, int gang_id) {
+    StoredReport** link = &shard->reports;
+    int discarded = 0;
+    shard->last_report = NULL;
+    while (*link != NULL) {
+        StoredReport* stored = *link;
+        if (gang_id == -1 || stored->report.gang_id == gang_id) {
+            *link = stored->next;
+            pool_put(&shard->report_pool, stored);
+            discarded++;
+        } else {
+            shard->last_report = stored;
+            link = &stored->next;
+        }
+    }
+    update_backlog(shard, -discarded);
+}
+
+// Ask a shard to clear the reports about a gang (decision stage)
+static void request_clear(Police* police, int shard_index, int gang_id) {
+    if (gang_id < 0 || gang_id >= POLICE_MAX_GANGS) return;
     
+    PoliceShard* shard = &police->shards[shard_index];
+    atomic_fetch_or_explicit(&shard->clear_gangs[gang_id / 64], 1ULL << (gang_id % 64), memory_order_relaxed);
+    sem_post(&shard->inbox_ready);
+}
+
+// Clear the reports of the gangs the decision stage asked for (shard thread only)
+static void apply_clears(PoliceShard* shard) {
+    for (int word = 0; word < (POLICE_MAX_GANGS + 63) / 64; word++) {
+        unsigned long long gangs = atomic_exchange_explicit(&shard->clear_gangs[word], 0, memory_order_relaxed);
+        while (gangs != 0) {
+            int bit = __builtin_ctzll(gangs);
+            gangs &= gangs - 1;
+            discard_reports(shard, word * 64 + bit);
+        }
+    }
+}
+
+// Process intelligence report
+void process_intelligence(PoliceShard* shard, IntelligenceReport report, SimulationConfig config) {
     // Log report receipt
     log_message("Police received intelligence from agent %d in gang %d (Suspicion: %d, Reliable: %s, Target: %s)",
                 report.agent_id, report.gang_id, report.suspicion_level,
-                report.is_reliable ? "Yes" : "No", 
+                report.is_reliable ? "Yes" : "No",
                 crime_type_to_string(report.suspected_target));
     
-    // Store the report
-    if (police->num_reports < police->report_capacity) {
-        police->reports[police->num_reports++] = report;
-    }
-    else {
-        // Expand capacity if needed
-        police->report_capacity *= 2;
-        police->reports = (IntelligenceReport*)realloc(police->reports, 
-                                                      police->report_capacity * sizeof(IntelligenceReport));
-        police->reports[police->num_reports++] = report;
-    }
-    
-    // Check if immediate action is needed for high-risk crimes
-    if (report.suspicion_level > config.police_action_threshold && report.is_reliable) {
-        switch (report.suspected_target) {
-            case KIDNAPPING:
-            case BANK_ROBBERY:
-            case ARM_TRAFFICKING:
-                log_message("Police prioritizing response to high-risk crime: %s by gang %d", 
-                           crime_type_to_string(report.suspected_target), report.gang_id);
-                // Immediate decision could be made here
-                break;
-            default:
-                // Normal processing for other crime types
-                break;
+    // Store the report - discarded reports are recycled, so this only allocates
+    // when the backlog outgrows every earlier one
+    StoredReport* stored = (StoredReport*)pool_get(&shard->report_pool);
+    if (stored != NULL) {
+        stored->report = report;
+        stored->next = NULL;
+        if (shard->last_report != NULL) {
+            shard->last_report->next = stored;
+        } else {
+            shard->reports = stored;
         }
+        shard->last_report = stored;
+        update_backlog(shard, 1);
     }
     
-    pthread_mutex_unlock(&police->police_mutex);
+    // High-risk crimes travel on the urgent lane, which every stage serves
+    // first, so the decision on them is made before any backlog is worked off
+    if (report.suspicion_level > config.police_action_threshold && report.is_reliable &&
+        crime_is_high_risk(report.suspected_target)) {
+        log_message("Police prioritizing response to high-risk crime: %s by gang %d",
+                   crime_type_to_string(report.suspected_target), report.gang_id);
+    }
 }
 
-// Decide whether to take action based on intelligence
-bool decide_on_action(Police* police, int gang_id, SimulationConfig config) {
-    pthread_mutex_lock(&police->police_mutex);
+// Gather the evidence a shard holds on a gang for the decision stage; the
+// task travels on the lane of the report that prompted it
+static PoliceTask gather_evidence(PoliceShard* shard, int gang_id, bool from_sweep, int lane, long long sent_us) {
+    PoliceTask evidence = {0};
+    int suspected_crimes[NUM_CRIME_TYPES] = {0}; // Tracking different crime types reported
     
-    int total_suspicion = 0;
-    int num_reports_for_gang = 0;
-    int num_reliable_reports = 0;
-    CrimeType suspected_crimes[7] = {0}; // Tracking different crime types reported
+    evidence.gang_id = gang_id;
+    evidence.shard = shard->index;
+    evidence.from_sweep = from_sweep;
+    evidence.lane = lane;
+    evidence.sent_us = sent_us;
     
     // Analyze reports for the specified gang
-    for (int i = 0; i < police->num_reports; i++) {
-        if (police->reports[i].gang_id == gang_id) {
-            total_suspicion += police->reports[i].suspicion_level;
-            num_reports_for_gang++;
+    for (StoredReport* stored = shard->reports; stored != NULL; stored = stored->next) {
+        IntelligenceReport* report = &stored->report;
+        if (report->gang_id == gang_id) {
+            evidence.total_suspicion += report->suspicion_level;
+            evidence.num_reports++;
             
             // Track crime types reported
-            suspected_crimes[police->reports[i].suspected_target]++;
+            suspected_crimes[report->suspected_target]++;
             
-            if (police->reports[i].is_reliable) {
-                num_reliable_reports++;
+            if (report->is_reliable) {
+                evidence.num_reliable_reports++;
             }
         }
     }
     
-    // Calculate average suspicion level
-    int avg_suspicion = 0;
-    if (num_reports_for_gang > 0) {
-        avg_suspicion = total_suspicion / num_reports_for_gang;
-    }
-    
     // Find most reported crime type
     int max_reports = 0;
-    CrimeType most_likely_crime = BANK_ROBBERY; // Default
+    evidence.most_likely_crime = BANK_ROBBERY; // Default
     for (int i = 0; i < NUM_CRIME_TYPES; i++) {
         if (suspected_crimes[i] > max_reports) {
             max_reports = suspected_crimes[i];
-            most_likely_crime = (CrimeType)i;
+            evidence.most_likely_crime = (CrimeType)i;
         }
     }
     
+    return evidence;
+}
+
+// Decide whether to take action based on the evidence gathered on a gang
+bool decide_on_action(const PoliceTask* evidence, SimulationConfig config) {
+    // Calculate average suspicion level
+    int avg_suspicion = 0;
+    if (evidence->num_reports > 0) {
+        avg_suspicion = evidence->total_suspicion / evidence->num_reports;
+    }
+    
     // Decision logic: take action if average suspicion is above threshold
     // and there is at least one reliable report, OR if suspicion is very high (>= 95)
-    bool decision = (avg_suspicion >= config.police_action_threshold && num_reliable_reports > 0) ||
-                   (avg_suspicion >= 95 && num_reports_for_gang >= 3);
+    bool decision = (avg_suspicion >= config.police_action_threshold && evidence->num_reliable_reports > 0) ||
+                   (avg_suspicion >= 95 && evidence->num_reports >= 3);
     
     // Add debug logging to understand why decisions aren't being made
-    if (num_reports_for_gang > 0) {
+    if (evidence->num_reports > 0) {
         log_message("Police analysis for gang %d: %d reports, avg suspicion %d, reliable reports %d, threshold %d",
-                    gang_id, num_reports_for_gang, avg_suspicion, num_reliable_reports, config.police_action_threshold);
+                    evidence->gang_id, evidence->num_reports, avg_suspicion, evidence->num_reliable_reports,
+                    config.police_action_threshold);
     }
     
     if (decision) {
+        METRICS_INC(decisions_act);
         log_message("Police decided to take action against gang %d (Avg suspicion: %d, Reliable reports: %d, Suspected crime: %s)",
-                    gang_id, avg_suspicion, num_reliable_reports, crime_type_to_string(most_likely_crime));
+                    evidence->gang_id, avg_suspicion, evidence->num_reliable_reports,
+                    crime_type_to_string(evidence->most_likely_crime));
+    }
+    else {
+        METRICS_INC(decisions_hold);
     }
-    
-    pthread_mutex_unlock(&police->police_mutex);
     
     return decision;
 }
 
-// Arrest gang members
+// Arrest gang members (arrest stage, once it has attached the shared state)
 void arrest_gang_members(Police* police, int gang_id, SimulationConfig config) {
-    // Get shared memory to communicate with the gang process
-    int shm_id = shmget(SHARED_MEMORY_KEY, 0, 0);
-    if (shm_id == -1) {
-        perror("Failed to find shared memory for arrest");
-        return;
-    }
-    
-    SharedState* shm = attach_shared_memory(shm_id);
+    SharedState* shm = police->shm;
+    if (shm == NULL) return;
     
     // Set the gang's prison time - random value between min and max from config
     int prison_time = random_int(config.prison_time_min, config.prison_time_max);
     
-    // Get the semaphore ID - try to find it the same way we found the shared memory
-    int sem_id = -1;
-    for (int i = 0; i < 100; i++) {  // Try some IDs to find the semaphore
-        sem_id = semget(SEMAPHORE_KEY, 0, 0);
-        if (sem_id != -1) break;
-    }
-    
-    if (sem_id == -1) {
-        perror("Failed to find semaphore for arrest");
-        detach_shared_memory(shm);
-        return;
-    }
-    
     // Update the gang status in shared memory
-    semaphore_wait(sem_id, 0);  // Get exclusive access
+    semaphore_wait(police->sem_id, 0);  // Get exclusive access
     
     if (gang_id < shm->num_gangs) {
         // Set arrest status
         shm->gang_status[gang_id].is_arrested = true;
         shm->gang_status[gang_id].prison_time = prison_time;
         shm->gang_status[gang_id].arrest_notification_seen = false;
+        publish_state_change(shm);
         
         log_message("Police arrested members of gang %d for %d time units", gang_id, prison_time);
+        METRICS_INC(arrests);
     }
     
-    semaphore_signal(sem_id, 0);  // Release exclusive access
+    semaphore_signal(police->sem_id, 0);  // Release exclusive access
     
     // Update statistics
-    pthread_mutex_lock(&police->police_mutex);
-    police->thwarted_missions++;
-    pthread_mutex_unlock(&police->police_mutex);
-    
-    // Detach from shared memory
-    detach_shared_memory(shm);
+    atomic_fetch_add_explicit(&police->thwarted_missions, 1, memory_order_relaxed);
 }
 
-// Police routine (background thread)
-void* police_routine(void* arg) {
-    Police* police = (Police*)arg;
+// Count a thwarted mission in shared memory
+static void record_thwarted_mission(Police* police) {
+    SharedState* shm = police->shm;
+    if (shm == NULL) return;
     
-    // Get configuration for decision making
-    SimulationConfig config = load_config("config/simulation_config.txt");
+    semaphore_wait(police->sem_id, 0);
+    shm->total_thwarted_missions++;
+    publish_state_change(shm);
+    semaphore_signal(police->sem_id, 0);
+}
+
+// Look over all of a shard's reports, pass the evidence on the gang reported
+// most to the decision stage and clear out stale reports
+static void sweep_reports(PoliceShard* shard) {
+    int max_gang_id = -1;
+    int max_reports = 0;
     
-    // Main police monitoring loop
-    while (1) {
-        int max_gang_id = -1;
-        int max_reports = 0;
-        bool should_take_action = false;
+    {
+        int reports_by_gang[100] = {0};  // Count reports by gang ID (assumes max 100 gangs)
         
-        // Analyze all reports to identify patterns (with proper mutex handling)
-        pthread_mutex_lock(&police->police_mutex);
-        {
-            int reports_by_gang[100] = {0};  // Count reports by gang ID (assumes max 100 gangs)
+        for (StoredReport* stored = shard->reports; stored != NULL; stored = stored->next) {
+            int gang_id = stored->report.gang_id;
+            reports_by_gang[gang_id]++;
             
-            for (int i = 0; i < police->num_reports; i++) {
-                int gang_id = police->reports[i].gang_id;
-                reports_by_gang[gang_id]++;
-                
-                if (reports_by_gang[gang_id] > max_reports) {
-                    max_reports = reports_by_gang[gang_id];
-                    max_gang_id = gang_id;
-                }
+            if (reports_by_gang[gang_id] > max_reports) {
+                max_reports = reports_by_gang[gang_id];
+                max_gang_id = gang_id;
             }
         }
-        pthread_mutex_unlock(&police->police_mutex);
+    }
+    
+    // Log police activity periodically
+    if (max_gang_id >= 0 && max_reports > 2) {
+        log_message("Police monitoring gang %d closely (%d reports received)",
+                   max_gang_id, max_reports);
         
-        // Log police activity periodically
-        if (max_gang_id >= 0 && max_reports > 2) {
-            log_message("Police monitoring gang %d closely (%d reports received)", 
-                       max_gang_id, max_reports);
-            
-            // Check if we should take action against the most reported gang
-            should_take_action = decide_on_action(police, max_gang_id, config);
-            
-            if (should_take_action) {
-                log_message("Police routine decided to take proactive action against gang %d", max_gang_id);
-                arrest_gang_members(police, max_gang_id, config);
-                
-                // Update shared memory
-                int shm_id = shmget(SHARED_MEMORY_KEY, 0, 0);
-                if (shm_id != -1) {
-                    SharedState* shm = attach_shared_memory(shm_id);
-                    int sem_id = semget(SEMAPHORE_KEY, 0, 0);
-                    if (sem_id != -1) {
-                        semaphore_wait(sem_id, 0);
-                        shm->total_thwarted_missions++;
-                        semaphore_signal(sem_id, 0);
-                    }
-                    detach_shared_memory(shm);
-                }
-                
-                // Clear reports for this gang after successful arrest
-                pthread_mutex_lock(&police->police_mutex);
-                int new_report_count = 0;
-                for (int i = 0; i < police->num_reports; i++) {
-                    if (police->reports[i].gang_id != max_gang_id) {
-                        police->reports[new_report_count++] = police->reports[i];
-                    }
-                }
-                police->num_reports = new_report_count;
-                pthread_mutex_unlock(&police->police_mutex);
-            } else {
-                // If no action taken but we have many reports, clear old reports to prevent infinite loop
-                // Clear reports for gangs that have been analyzed multiple times without action
-                if (max_reports >= 5) {
-                    log_message("Police clearing stale reports for gang %d (insufficient evidence for action)", max_gang_id);
-                    pthread_mutex_lock(&police->police_mutex);
-                    int new_report_count = 0;
-                    for (int i = 0; i < police->num_reports; i++) {
-                        if (police->reports[i].gang_id != max_gang_id) {
-                            police->reports[new_report_count++] = police->reports[i];
-                        }
-                    }
-                    police->num_reports = new_report_count;
-                    pthread_mutex_unlock(&police->police_mutex);
-                }
-            }
+        // Have the decision stage check whether to act against the most reported gang
+        pass_on(shard->police, &shard->police->decisions,
+                gather_evidence(shard, max_gang_id, true, POLICE_LANE_ROUTINE, 0));
+    }
+    
+    // Periodic cleanup: clear all reports every 30 sweeps to prevent infinite accumulation
+    shard->sweeps++;
+    if (shard->sweeps >= 30) {
+        shard->sweeps = 0;
+        if (shard->num_reports > 10) {
+            log_message("Police performing periodic cleanup of %d stale reports", shard->num_reports);
+            discard_reports(shard, -1); // Clear all reports periodically
+        }
+    }
+}
+
+// Police shard routine (aggregation stage, one thread per shard): stores the
+// reports routed to the shard, passes the evidence on their gangs to the
+// decision stage, and sweeps its reports every POLICE_SWEEP_INTERVAL
+void* police_shard_routine(void* arg) {
+    PoliceShard* shard = (PoliceShard*)arg;
+    Police* police = shard->police;
+    SimulationConfig config = police->config;
+    
+    // Every shard of every police process gets a police worker CPU of its own, as far as they go
+    placement_pin_thread(PLACEMENT_ROLE_POLICE_WORKER, police->partition * police->num_shards + shard->index);
+    
+    shard->next_sweep_us = monotonic_time_us() + POLICE_SWEEP_INTERVAL * 1000000LL;
+    while (atomic_load(&police->running)) {
+        wait_for_work(&shard->inbox_ready, shard->next_sweep_us - monotonic_time_us());
+        apply_clears(shard);
+        
+        // Process intelligence and have the decision stage weigh it
+        RoutedReport routed;
+        while (take_intelligence(shard, &routed)) {
+            process_intelligence(shard, routed.report, config);
+            pass_on(police, &police->decisions,
+                    gather_evidence(shard, routed.report.gang_id, false, routed.lane, routed.sent_us));
+            metrics_observe_police_stage(POLICE_STAGE_AGGREGATION, monotonic_time_us() - routed.queued_us);
         }
         
-        // Periodic cleanup: clear all reports every 30 iterations to prevent infinite accumulation
-        static int cleanup_counter = 0;
-        cleanup_counter++;
-        if (cleanup_counter >= 30) {
-            cleanup_counter = 0;
-            pthread_mutex_lock(&police->police_mutex);
-            if (police->num_reports > 10) {
-                log_message("Police performing periodic cleanup of %d stale reports", police->num_reports);
-                police->num_reports = 0; // Clear all reports periodically
+        if (monotonic_time_us() >= shard->next_sweep_us) {
+            sweep_reports(shard);
+            shard->next_sweep_us = monotonic_time_us() + POLICE_SWEEP_INTERVAL * 1000000LL;
+        }
+    }
+    
+    return NULL;
+}
+
+// Police decision routine (decision stage): weighs the evidence gathered by
+// the shards and passes arrest orders on to the arrest stage
+void* police_decision_routine(void* arg) {
+    Police* police = (Police*)arg;
+    SimulationConfig config = police->config;
+    
+    while (atomic_load(&police->running)) {
+        PoliceTask evidence;
+        if (!police_queue_pop(&police->decisions, &evidence)) {
+            wait_for_work(&police->decisions.ready, POLICE_STAGE_IDLE_US);
+            continue;
+        }
+        
+        bool act = decide_on_action(&evidence, config);
+        
+        // A sweep clears the reports it acted on, and many reports that were not enough
+        if (evidence.from_sweep) {
+            if (act) {
+                log_message("Police routine decided to take proactive action against gang %d", evidence.gang_id);
+                request_clear(police, evidence.shard, evidence.gang_id);
+            } else if (evidence.num_reports >= 5) {
+                log_message("Police clearing stale reports for gang %d (insufficient evidence for action)",
+                            evidence.gang_id);
+                request_clear(police, evidence.shard, evidence.gang_id);
             }
-            pthread_mutex_unlock(&police->police_mutex);
         }
         
-        // Sleep to avoid busy waiting
-        sleep(2);
+        long long now_us = monotonic_time_us();
+        metrics_observe_police_stage(POLICE_STAGE_DECISION, now_us - evidence.queued_us);
+        if (evidence.sent_us > 0) {
+            metrics_observe_report_decision(evidence.lane, now_us - evidence.sent_us);
+        }
+        if (act) {
+            pass_on(police, &police->arrests, evidence);
+        }
     }
     
     return NULL;
 }
 
+// Police arrest routine (arrest stage): applies arrest orders to the shared
+// state, which it attaches once rather than for every arrest
+void* police_arrest_routine(void* arg) {
+    Police* police = (Police*)arg;
+    SimulationConfig config = police->config;
+    
+    // Get shared memory to communicate with the gang processes
+    int shm_id = shmget(RUN_KEY(SHARED_MEMORY_KEY), 0, 0);
+    if (shm_id == -1) {
+        perror("Failed to find shared memory for arrests");
+        return NULL;
+    }
+    
+    // Get the semaphore ID - try to find it the same way we found the shared memory
+    int sem_id = -1;
+    for (int i = 0; i < 100; i++) {  // Try some IDs to find the semaphore
+        sem_id = open_semaphore_set();
+        if (sem_id != -1) break;
+    }
+    
+    if (sem_id == -1) {
+        perror("Failed to find semaphore for arrests");
+        return NULL;
+    }
+    
+    police->shm = attach_shared_memory(shm_id);
+    police->sem_id = sem_id;
+    
+    while (atomic_load(&police->running)) {
+        PoliceTask order;
+        if (!police_queue_pop(&police->arrests, &order)) {
+            wait_for_work(&police->arrests.ready, POLICE_STAGE_IDLE_US);
+            continue;
+        }
+        
+        arrest_gang_members(police, order.gang_id, config);
+        record_thwarted_mission(police);
+        metrics_observe_police_stage(POLICE_STAGE_ARREST, monotonic_time_us() - order.queued_us);
+    }
+    
+    // Detach from shared memory
+    detach_shared_memory(police->shm);
+    police->shm = NULL;
+    return NULL;
+}
+
+// Stop the threads of every stage and wait for them to return
+void stop_police(Police* police) {
+    atomic_store(&police->running, false);
+    for (int i = 0; i < police->num_shards; i++) {
+        sem_post(&police->shards[i].inbox_ready);
+    }
+    sem_post(&police->decisions.ready);
+    sem_post(&police->arrests.ready);
+    
+    for (int i = 0; i < police->num_shards; i++) {
+        pthread_join(police->shards[i].thread, NULL);
+    }
+    pthread_join(police->decision_thread, NULL);
+    pthread_join(police->arrest_thread, NULL);
+}
+
 // Clean up police resources
 void cleanup_police(Police* police) {
-    // Destroy mutex and condition variable
-    pthread_mutex_destroy(&police->police_mutex);
-    pthread_cond_destroy(&police->police_cond);
-    
     // Free allocated memory
-    free(police->reports);
+    for (int i = 0; i < police->num_shards; i++) {
+        sem_destroy(&police->shards[i].inbox_ready);
+        pool_destroy(&police->shards[i].report_pool);
+    }
+    free(police->shards);
+    police->shards = NULL;
+    police->num_shards = 0;
+    sem_destroy(&police->decisions.ready);
+    sem_destroy(&police->arrests.ready);
     
     log_message("Police resources cleaned up");
 }
@@ -0,0 +1,551 @@
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glut.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include "../include/render_batch.h"
+
+// Number of segments used for status circles
+#define CIRCLE_SEGMENTS 20
+
+// Glyph atlas layout - the height is the power of two the font rows need, up to the maximum
+#define ATLAS_WIDTH 512
+#define ATLAS_MAX_HEIGHT 1024
+#define FIRST_GLYPH 32
+#define LAST_GLYPH 126
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+
+// Vertex formats
+typedef struct {
+    float x, y;
+    GLubyte color[4];
+} ColorVertex;
+
+typedef struct {
+    float x, y;
+    float u, v;
+    GLubyte color[4];
+} TextVertex;
+
+// Growable vertex array that is kept across frames and streamed into a VBO
+typedef struct {
+    void* data;
+    int count;
+    int capacity;
+    size_t vertex_size;
+    GLuint vbo;
+} VertexArray;
+
+// Position of one glyph in the atlas
+typedef struct {
+    short x, y;
+    short width;      // Advance width of the glyph
+} Glyph;
+
+// One font in the atlas
+typedef struct {
+    void* glut_font;
+    int cell_height;  // Height of a glyph cell in pixels
+    int descent;      // Pixels of the cell below the baseline
+    Glyph glyphs[NUM_GLYPHS];
+} AtlasFont;
+
+// Text drawn with the GLUT bitmap fonts while there is no glyph atlas
+typedef struct {
+    FontId font;
+    float x, y;
+    GLubyte color[4];
+    char* text;
+} BitmapText;
+
+// Batches for the current frame
+static VertexArray triangle_batch = { NULL, 0, 0, sizeof(ColorVertex), 0 };
+static VertexArray line_batch = { NULL, 0, 0, sizeof(ColorVertex), 0 };
+static VertexArray text_batch = { NULL, 0, 0, sizeof(TextVertex), 0 };
+static GLubyte current_color[4] = { 255, 255, 255, 255 };
+static BitmapText* bitmap_texts = NULL;
+static int bitmap_text_count = 0;
+static int bitmap_text_capacity = 0;
+
+// Precomputed unit circle
+static float circle_cos[CIRCLE_SEGMENTS + 1];
+static float circle_sin[CIRCLE_SEGMENTS + 1];
+
+// Renderer state
+static bool renderer_initialized = false;
+static bool use_vertex_buffers = false;
+static bool atlas_ready = false;
+static bool atlas_failed = false;
+static bool offscreen_failed = false;
+static int atlas_height = 0;
+static GLuint atlas_texture = 0;
+static AtlasFont fonts[NUM_FONTS];
+
+// Make room for `count` more vertices and return a pointer to the first one
+static void* reserve_vertices(VertexArray* array, int count) {
+    if (array->count + count > array->capacity) {
+        int new_capacity = array->capacity > 0 ? array->capacity : 1024;
+        while (new_capacity < array->count + count) {
+            new_capacity *= 2;
+        }
+
+        void* data = realloc(array->data, new_capacity * array->vertex_size);
+        if (data == NULL) {
+            fprintf(stderr, "Error: Failed to grow vertex batch\n");
+            return NULL;
+        }
+        array->data = data;
+        array->capacity = new_capacity;
+    }
+
+    void* first = (char*)array->data + array->count * array->vertex_size;
+    array->count += count;
+    return first;
+}
+
+// Drop the bitmap text queued for the previous frame
+static void clear_bitmap_texts() {
+    for (int i = 0; i < bitmap_text_count; i++) {
+        free(bitmap_texts[i].text);
+    }
+    bitmap_text_count = 0;
+}
+
+// Queue text to be drawn with glutBitmapCharacter when the frame is flushed
+static void queue_bitmap_text(FontId font, float x, float y, const char* text) {
+    if (bitmap_text_count == bitmap_text_capacity) {
+        int new_capacity = bitmap_text_capacity > 0 ? bitmap_text_capacity * 2 : 64;
+        BitmapText* texts = (BitmapText*)realloc(bitmap_texts, new_capacity * sizeof(BitmapText));
+        if (texts == NULL) {
+            fprintf(stderr, "Error: Failed to grow bitmap text queue\n");
+            return;
+        }
+        bitmap_texts = texts;
+        bitmap_text_capacity = new_capacity;
+    }
+
+    char* copy = strdup(text);
+    if (copy == NULL) return;
+
+    BitmapText* entry = &bitmap_texts[bitmap_text_count++];
+    entry->font = font;
+    entry->x = x;
+    entry->y = y;
+    memcpy(entry->color, current_color, sizeof(current_color));
+    entry->text = copy;
+}
+
+// Draw the queued bitmap text on top of the frame
+static void draw_bitmap_texts() {
+    for (int i = 0; i < bitmap_text_count; i++) {
+        BitmapText* entry = &bitmap_texts[i];
+        glColor4ubv(entry->color);
+        glRasterPos2f(entry->x, entry->y);
+        for (const char* p = entry->text; *p != '\0'; p++) {
+            glutBitmapCharacter(fonts[entry->font].glut_font, (unsigned char)*p);
+        }
+    }
+}
+
+static void set_color_vertex(ColorVertex* vertex, float x, float y) {
+    vertex->x = x;
+    vertex->y = y;
+    memcpy(vertex->color, current_color, sizeof(current_color));
+}
+
+// Vertex buffers are core since OpenGL 1.5; older contexts draw from client memory
+static bool vertex_buffers_supported() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0;
+    int minor = 0;
+
+    if (version == NULL || sscanf(version, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    return major > 1 || (major == 1 && minor >= 5);
+}
+
+// Assign atlas cells to every glyph of every font and size the atlas to fit them
+static bool layout_atlas() {
+    fonts[FONT_HELVETICA_12] = (AtlasFont){ GLUT_BITMAP_HELVETICA_12, 16, 4 };
+    fonts[FONT_HELVETICA_18] = (AtlasFont){ GLUT_BITMAP_HELVETICA_18, 24, 6 };
+    fonts[FONT_FIXED_8_BY_13] = (AtlasFont){ GLUT_BITMAP_8_BY_13, 14, 3 };
+
+    int cursor_x = 0;
+    int cursor_y = 0;
+    for (int f = 0; f < NUM_FONTS; f++) {
+        AtlasFont* font = &fonts[f];
+        for (int c = FIRST_GLYPH; c <= LAST_GLYPH; c++) {
+            Glyph* glyph = &font->glyphs[c - FIRST_GLYPH];
+            glyph->width = glutBitmapWidth(font->glut_font, c);
+
+            // One pixel of padding on each side for glyphs that overhang their origin
+            if (cursor_x + glyph->width + 2 > ATLAS_WIDTH) {
+                cursor_x = 0;
+                cursor_y += font->cell_height;
+            }
+            glyph->x = cursor_x;
+            glyph->y = cursor_y;
+            cursor_x += glyph->width + 2;
+        }
+
+        // Every font starts on a fresh row
+        cursor_x = 0;
+        cursor_y += font->cell_height;
+    }
+
+    atlas_height = 1;
+    while (atlas_height < cursor_y) {
+        atlas_height *= 2;
+    }
+    return atlas_height <= ATLAS_MAX_HEIGHT;
+}
+
+// Framebuffer objects are core since OpenGL 3.0 and an extension before that
+static bool framebuffers_supported() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    int major = 0;
+
+    if (version != NULL && sscanf(version, "%d", &major) == 1 && major >= 3) {
+        return true;
+    }
+    return extensions != NULL && strstr(extensions, "GL_ARB_framebuffer_object") != NULL;
+}
+
+// Draw every glyph at its atlas cell into the current draw buffer
+static void draw_atlas_glyphs() {
+    glDisable(GL_BLEND);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int f = 0; f < NUM_FONTS; f++) {
+        AtlasFont* font = &fonts[f];
+        for (int c = FIRST_GLYPH; c <= LAST_GLYPH; c++) {
+            Glyph* glyph = &font->glyphs[c - FIRST_GLYPH];
+            glRasterPos2i(glyph->x + 1, glyph->y + font->descent);
+            glutBitmapCharacter(font->glut_font, c);
+        }
+    }
+}
+
+// Rasterize the glyphs into an offscreen framebuffer and read them back.
+// Unlike the window this does not depend on the window size or on it being uncovered.
+static bool rasterize_offscreen(GLubyte* pixels) {
+    GLuint framebuffer = 0;
+    GLuint renderbuffer = 0;
+    GLint viewport[4];
+    bool complete;
+
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, ATLAS_WIDTH, atlas_height);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+
+    complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete) {
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, ATLAS_WIDTH, atlas_height);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(0, ATLAS_WIDTH, 0, atlas_height, -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        draw_atlas_glyphs();
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, ATLAS_WIDTH, atlas_height, GL_RED, GL_UNSIGNED_BYTE, pixels);
+
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &renderbuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+    return complete;
+}
+
+// Rasterize the GLUT bitmap fonts once into an alpha texture.
+// Uses an offscreen framebuffer where available, otherwise the back buffer of
+// a window at least as large as the atlas. Until then text is drawn directly
+// with the GLUT bitmap fonts.
+static void build_glyph_atlas(int window_width, int window_height) {
+    if (atlas_failed) return;
+
+    if (!layout_atlas()) {
+        fprintf(stderr, "Error: Dashboard fonts need a glyph atlas taller than %d pixels\n", ATLAS_MAX_HEIGHT);
+        atlas_failed = true;
+        return;
+    }
+
+    bool offscreen = framebuffers_supported() && !offscreen_failed;
+    if (!offscreen && (window_width < ATLAS_WIDTH || window_height < atlas_height)) {
+        return; // Try again once the window is large enough
+    }
+
+    GLubyte* pixels = (GLubyte*)malloc(ATLAS_WIDTH * atlas_height);
+    if (pixels == NULL) {
+        fprintf(stderr, "Error: Failed to allocate glyph atlas\n");
+        atlas_failed = true;
+        return;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (offscreen && !rasterize_offscreen(pixels)) {
+        offscreen_failed = true;
+        offscreen = false;
+    }
+    if (!offscreen) {
+        if (window_width < ATLAS_WIDTH || window_height < atlas_height) {
+            free(pixels);
+            return;
+        }
+        draw_atlas_glyphs();
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, ATLAS_WIDTH, atlas_height, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    // Turn the glyphs into the atlas texture
+    glGenTextures(1, &atlas_texture);
+    glBindTexture(GL_TEXTURE_2D, atlas_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_WIDTH, atlas_height, 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    free(pixels);
+
+    atlas_ready = true;
+    printf("Glyph atlas built (%dx%d, %s)\n", ATLAS_WIDTH, atlas_height, offscreen ? "offscreen" : "window");
+}
+
+// One-time renderer setup (needs a current GL context)
+static void initialize_renderer() {
+    for (int i = 0; i <= CIRCLE_SEGMENTS; i++) {
+        float angle = 2.0f * 3.14159f * i / CIRCLE_SEGMENTS;
+        circle_cos[i] = cosf(angle);
+        circle_sin[i] = sinf(angle);
+    }
+
+    use_vertex_buffers = vertex_buffers_supported();
+    if (use_vertex_buffers) {
+        glGenBuffers(1, &triangle_batch.vbo);
+        glGenBuffers(1, &line_batch.vbo);
+        glGenBuffers(1, &text_batch.vbo);
+    }
+
+    printf("Dashboard renderer using %s\n", use_vertex_buffers ? "vertex buffers" : "client vertex arrays");
+    renderer_initialized = true;
+}
+
+// Start collecting a new frame
+void render_batch_begin(int window_width, int window_height) {
+    if (!renderer_initialized) {
+        initialize_renderer();
+    }
+    if (!atlas_ready) {
+        build_glyph_atlas(window_width, window_height);
+    }
+
+    triangle_batch.count = 0;
+    line_batch.count = 0;
+    text_batch.count = 0;
+    clear_bitmap_texts();
+}
+
+// Upload one batch and draw it with a single call
+static void draw_batch(VertexArray* array, GLenum mode, bool textured) {
+    if (array->count == 0) return;
+
+    const char* base = (const char*)array->data;
+    if (use_vertex_buffers) {
+        glBindBuffer(GL_ARRAY_BUFFER, array->vbo);
+        // Orphan the previous contents so the driver never stalls on the last frame
+        glBufferData(GL_ARRAY_BUFFER, array->count * array->vertex_size, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, array->count * array->vertex_size, array->data);
+        base = NULL;
+    }
+
+    GLsizei stride = (GLsizei)array->vertex_size;
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    if (textured) {
+        glVertexPointer(2, GL_FLOAT, stride, base + offsetof(TextVertex, x));
+        glColorPointer(4, GL_UNSIGNED_BYTE, stride, base + offsetof(TextVertex, color));
+        glTexCoordPointer(2, GL_FLOAT, stride, base + offsetof(TextVertex, u));
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, atlas_texture);
+    }
+    else {
+        glVertexPointer(2, GL_FLOAT, stride, base + offsetof(ColorVertex, x));
+        glColorPointer(4, GL_UNSIGNED_BYTE, stride, base + offsetof(ColorVertex, color));
+    }
+
+    glDrawArrays(mode, 0, array->count);
+
+    if (textured) {
+        glDisable(GL_TEXTURE_2D);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (use_vertex_buffers) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+// Draw everything collected since render_batch_begin(): geometry first, text on top
+void render_batch_flush() {
+    draw_batch(&triangle_batch, GL_TRIANGLES, false);
+    draw_batch(&line_batch, GL_LINES, false);
+    if (atlas_ready) {
+        draw_batch(&text_batch, GL_TRIANGLES, true);
+    }
+    draw_bitmap_texts();
+}
+
+// Release GL objects and vertex memory
+void render_batch_cleanup() {
+    VertexArray* batches[] = { &triangle_batch, &line_batch, &text_batch };
+
+    for (int i = 0; i < 3; i++) {
+        if (use_vertex_buffers && batches[i]->vbo != 0) {
+            glDeleteBuffers(1, &batches[i]->vbo);
+            batches[i]->vbo = 0;
+        }
+        free(batches[i]->data);
+        batches[i]->data = NULL;
+        batches[i]->count = 0;
+        batches[i]->capacity = 0;
+    }
+    clear_bitmap_texts();
+    free(bitmap_texts);
+    bitmap_texts = NULL;
+    bitmap_text_capacity = 0;
+
+    if (atlas_texture != 0) {
+        glDeleteTextures(1, &atlas_texture);
+        atlas_texture = 0;
+    }
+    atlas_ready = false;
+    renderer_initialized = false;
+}
+
+// Set the color of subsequent primitives
+void render_set_color(float r, float g, float b, float a) {
+    current_color[0] = (GLubyte)(r * 255.0f);
+    current_color[1] = (GLubyte)(g * 255.0f);
+    current_color[2] = (GLubyte)(b * 255.0f);
+    current_color[3] = (GLubyte)(a * 255.0f);
+}
+
+// Axis-aligned rectangle between two corners
+void render_quad(float x0, float y0, float x1, float y1) {
+    ColorVertex* v = (ColorVertex*)reserve_vertices(&triangle_batch, 6);
+    if (v == NULL) return;
+
+    set_color_vertex(&v[0], x0, y0);
+    set_color_vertex(&v[1], x1, y0);
+    set_color_vertex(&v[2], x1, y1);
+    set_color_vertex(&v[3], x0, y0);
+    set_color_vertex(&v[4], x1, y1);
+    set_color_vertex(&v[5], x0, y1);
+}
+
+void render_triangle(float x1, float y1, float x2, float y2, float x3, float y3) {
+    ColorVertex* v = (ColorVertex*)reserve_vertices(&triangle_batch, 3);
+    if (v == NULL) return;
+
+    set_color_vertex(&v[0], x1, y1);
+    set_color_vertex(&v[1], x2, y2);
+    set_color_vertex(&v[2], x3, y3);
+}
+
+void render_line(float x1, float y1, float x2, float y2) {
+    ColorVertex* v = (ColorVertex*)reserve_vertices(&line_batch, 2);
+    if (v == NULL) return;
+
+    set_color_vertex(&v[0], x1, y1);
+    set_color_vertex(&v[1], x2, y2);
+}
+
+// Filled circle built from the precomputed unit circle
+void render_circle(float cx, float cy, float radius) {
+    ColorVertex* v = (ColorVertex*)reserve_vertices(&triangle_batch, CIRCLE_SEGMENTS * 3);
+    if (v == NULL) return;
+
+    for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+        set_color_vertex(&v[i * 3], cx, cy);
+        set_color_vertex(&v[i * 3 + 1], cx + radius * circle_cos[i], cy + radius * circle_sin[i]);
+        set_color_vertex(&v[i * 3 + 2], cx + radius * circle_cos[i + 1], cy + radius * circle_sin[i + 1]);
+    }
+}
+
+// Text with its baseline starting at (x, y), like glRasterPos + glutBitmapCharacter
+void render_text(FontId font_id, float x, float y, const char* text) {
+    if (!atlas_ready) {
+        queue_bitmap_text(font_id, x, y, text);
+        return;
+    }
+
+    AtlasFont* font = &fonts[font_id];
+    float bottom = y - font->descent;
+    float top = bottom + font->cell_height;
+
+    for (const char* p = text; *p != '\0'; p++) {
+        int c = (unsigned char)*p;
+        if (c < FIRST_GLYPH || c > LAST_GLYPH) continue;
+
+        Glyph* glyph = &font->glyphs[c - FIRST_GLYPH];
+        TextVertex* v = (TextVertex*)reserve_vertices(&text_batch, 6);
+        if (v == NULL) return;
+
+        // The atlas cell is padded by one pixel on each side of the glyph
+        float left = x - 1;
+        float right = x + glyph->width + 1;
+        float u0 = (float)glyph->x / ATLAS_WIDTH;
+        float u1 = (float)(glyph->x + glyph->width + 2) / ATLAS_WIDTH;
+        float v0 = (float)glyph->y / atlas_height;
+        float v1 = (float)(glyph->y + font->cell_height) / atlas_height;
+
+        TextVertex corners[6] = {
+            { left, bottom, u0, v0 }, { right, bottom, u1, v0 }, { right, top, u1, v1 },
+            { left, bottom, u0, v0 }, { right, top, u1, v1 }, { left, top, u0, v1 }
+        };
+        for (int i = 0; i < 6; i++) {
+            memcpy(corners[i].color, current_color, sizeof(current_color));
+            v[i] = corners[i];
+        }
+
+        x += glyph->width;
+    }
+}
+
+// Width of a string in pixels (same as glutBitmapLength)
+int render_text_width(FontId font_id, const char* text) {
+    if (!atlas_ready) {
+        return glutBitmapLength(fonts[font_id].glut_font, (const unsigned char*)text);
+    }
+
+    int width = 0;
+    for (const char* p = text; *p != '\0'; p++) {
+        int c = (unsigned char)*p;
+        if (c >= FIRST_GLYPH && c <= LAST_GLYPH) {
+            width += fonts[font_id].glyphs[c - FIRST_GLYPH].width;
+        }
+    }
+    return width;
+}
@@ -0,0 +1,509 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/state_stream.h"
+#include "../include/visualization.h"
+#include "../include/utils.h"
+
+// Most clients served at once - further connections are closed right away
+#define STREAM_MAX_CLIENTS 16
+
+// Backlog a client may hold on top of one full snapshot before it is resynced
+#define STREAM_CLIENT_BACKLOG 65536
+
+// A client whose backlog has not moved for this long is dropped
+#define STREAM_STALL_TIMEOUT_MS 5000
+
+// Largest encoding of one gang: flags byte plus five 5-byte varints, plus id gap and mask
+#define STREAM_MAX_GANG_BYTES 32
+
+// Everything one frame describes, captured at a single point in time
+typedef struct {
+    int num_gangs;
+    int total_successful_missions;
+    int total_thwarted_missions;
+    int total_executed_agents;
+    bool simulation_running;
+    GangVisState* gang_states;
+} StreamState;
+
+// Growable byte buffer frames are encoded into
+typedef struct {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} StreamBuffer;
+
+// One connected consumer
+typedef struct {
+    int fd;
+    unsigned char* pending;      // Whole frames not yet written
+    size_t length;               // Bytes in pending
+    size_t sent;                 // Bytes of pending already written
+    bool resync;                 // Skipped a delta - owes a snapshot once drained
+    long long stalled_since;     // When the backlog last stopped moving (0 while empty)
+} StreamClient;
+
+// Cleared by SIGINT/SIGTERM to stop the stream loop
+static volatile sig_atomic_t stream_running = 1;
+
+static void stream_signal_handler(int sig) {
+    stream_running = 0;
+}
+
+// Make sure the buffer can take `extra` more bytes
+static bool buffer_reserve(StreamBuffer* buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) return true;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + extra) capacity *= 2;
+
+    unsigned char* data = (unsigned char*)realloc(buffer->data, capacity);
+    if (data == NULL) return false;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+// Append one byte - callers reserve space first
+static void put_u8(StreamBuffer* buffer, unsigned int value) {
+    buffer->data[buffer->length++] = (unsigned char)value;
+}
+
+// Append a little-endian 32-bit integer
+static void put_u32(StreamBuffer* buffer, unsigned int value) {
+    for (int i = 0; i < 4; i++) {
+        put_u8(buffer, (value >> (8 * i)) & 0xFF);
+    }
+}
+
+// Append an unsigned LEB128 varint - small values take a single byte.
+// The stream carries no negative values, anything below zero is sent as 0.
+static void put_varint(StreamBuffer* buffer, int value) {
+    unsigned int v = value > 0 ? (unsigned int)value : 0;
+    while (v >= 0x80) {
+        put_u8(buffer, (v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    put_u8(buffer, v);
+}
+
+// Open a frame - the payload length is patched in by end_frame()
+static size_t begin_frame(StreamBuffer* buffer, int type, unsigned int tick) {
+    size_t start = buffer->length;
+    put_u32(buffer, STREAM_MAGIC);
+    put_u8(buffer, type);
+    put_u8(buffer, 0);
+    put_u8(buffer, 0);
+    put_u8(buffer, 0);
+    put_u32(buffer, tick);
+    put_u32(buffer, 0);
+    return start;
+}
+
+// Close a frame by writing its payload length into the header
+static void end_frame(StreamBuffer* buffer, size_t start) {
+    unsigned int payload = (unsigned int)(buffer->length - start - STREAM_HEADER_SIZE);
+    for (int i = 0; i < 4; i++) {
+        buffer->data[start + 12 + i] = (payload >> (8 * i)) & 0xFF;
+    }
+}
+
+// Flag byte of one gang
+static unsigned int gang_flags(const GangVisState* gang) {
+    return (gang->is_active ? STREAM_FLAG_ACTIVE : 0) |
+           (gang->is_in_prison ? STREAM_FLAG_IN_PRISON : 0);
+}
+
+// Mask of the fields that differ between two states of a gang (all of them for a new gang)
+static unsigned int changed_fields(const GangVisState* now, const GangVisState* old) {
+    if (old == NULL) {
+        return STREAM_FIELD_FLAGS | STREAM_FIELD_PRISON_TIME | STREAM_FIELD_PREPARATION |
+               STREAM_FIELD_TARGET | STREAM_FIELD_MEMBERS | STREAM_FIELD_AGENTS;
+    }
+
+    unsigned int fields = 0;
+    if (gang_flags(now) != gang_flags(old)) fields |= STREAM_FIELD_FLAGS;
+    if (now->prison_time_remaining != old->prison_time_remaining) fields |= STREAM_FIELD_PRISON_TIME;
+    if (now->preparation_level != old->preparation_level) fields |= STREAM_FIELD_PREPARATION;
+    if (now->current_target != old->current_target) fields |= STREAM_FIELD_TARGET;
+    if (now->num_members != old->num_members) fields |= STREAM_FIELD_MEMBERS;
+    if (now->num_agents != old->num_agents) fields |= STREAM_FIELD_AGENTS;
+    return fields;
+}
+
+// Encode a full snapshot frame of `state`
+static bool encode_snapshot(StreamBuffer* buffer, const StreamState* state, unsigned int tick) {
+    if (!buffer_reserve(buffer, STREAM_HEADER_SIZE + 32 + (size_t)state->num_gangs * STREAM_MAX_GANG_BYTES)) {
+        return false;
+    }
+
+    size_t start = begin_frame(buffer, STREAM_FRAME_SNAPSHOT, tick);
+    put_varint(buffer, state->num_gangs);
+    put_varint(buffer, state->total_successful_missions);
+    put_varint(buffer, state->total_thwarted_missions);
+    put_varint(buffer, state->total_executed_agents);
+    put_u8(buffer, state->simulation_running ? 1 : 0);
+
+    for (int i = 0; i < state->num_gangs; i++) {
+        const GangVisState* gang = &state->gang_states[i];
+        put_u8(buffer, gang_flags(gang));
+        put_varint(buffer, gang->prison_time_remaining);
+        put_varint(buffer, gang->preparation_level);
+        put_varint(buffer, gang->current_target);
+        put_varint(buffer, gang->num_members);
+        put_varint(buffer, gang->num_agents);
+    }
+
+    end_frame(buffer, start);
+    return true;
+}
+
+// Encode the changes from `before` to `after` as a delta frame.
+// Returns false when nothing changed and no frame was written.
+static bool encode_delta(StreamBuffer* buffer, const StreamState* before, const StreamState* after,
+                         unsigned int tick) {
+    unsigned int counters = 0;
+    if (after->total_successful_missions != before->total_successful_missions) counters |= STREAM_COUNTER_SUCCESSFUL;
+    if (after->total_thwarted_missions != before->total_thwarted_missions) counters |= STREAM_COUNTER_THWARTED;
+    if (after->total_executed_agents != before->total_executed_agents) counters |= STREAM_COUNTER_EXECUTED;
+    if (after->simulation_running != before->simulation_running) counters |= STREAM_COUNTER_RUNNING;
+    if (after->num_gangs != before->num_gangs) counters |= STREAM_COUNTER_NUM_GANGS;
+
+    // Gangs beyond the previous count are new and carry every field
+    int changed = 0;
+    for (int i = 0; i < after->num_gangs; i++) {
+        const GangVisState* old = i < before->num_gangs ? &before->gang_states[i] : NULL;
+        if (changed_fields(&after->gang_states[i], old) != 0) changed++;
+    }
+
+    if (counters == 0 && changed == 0) return false;
+    if (!buffer_reserve(buffer, STREAM_HEADER_SIZE + 32 + (size_t)changed * STREAM_MAX_GANG_BYTES)) {
+        return false;
+    }
+
+    size_t start = begin_frame(buffer, STREAM_FRAME_DELTA, tick);
+    put_u8(buffer, counters);
+    if (counters & STREAM_COUNTER_SUCCESSFUL) put_varint(buffer, after->total_successful_missions);
+    if (counters & STREAM_COUNTER_THWARTED) put_varint(buffer, after->total_thwarted_missions);
+    if (counters & STREAM_COUNTER_EXECUTED) put_varint(buffer, after->total_executed_agents);
+    if (counters & STREAM_COUNTER_RUNNING) put_varint(buffer, after->simulation_running ? 1 : 0);
+    if (counters & STREAM_COUNTER_NUM_GANGS) put_varint(buffer, after->num_gangs);
+
+    put_varint(buffer, changed);
+    int previous_id = -1;
+    for (int i = 0; i < after->num_gangs; i++) {
+        const GangVisState* now = &after->gang_states[i];
+        const GangVisState* old = i < before->num_gangs ? &before->gang_states[i] : NULL;
+
+        unsigned int fields = changed_fields(now, old);
+        if (fields == 0) continue;
+
+        put_varint(buffer, i - previous_id - 1);
+        put_u8(buffer, fields);
+        if (fields & STREAM_FIELD_FLAGS) put_u8(buffer, gang_flags(now));
+        if (fields & STREAM_FIELD_PRISON_TIME) put_varint(buffer, now->prison_time_remaining);
+        if (fields & STREAM_FIELD_PREPARATION) put_varint(buffer, now->preparation_level);
+        if (fields & STREAM_FIELD_TARGET) put_varint(buffer, now->current_target);
+        if (fields & STREAM_FIELD_MEMBERS) put_varint(buffer, now->num_members);
+        if (fields & STREAM_FIELD_AGENTS) put_varint(buffer, now->num_agents);
+        previous_id = i;
+    }
+
+    end_frame(buffer, start);
+    return true;
+}
+
+// Sample shared memory into `state`. Gangs whose record cannot be read
+// consistently right now keep the values of the previous tick.
+static void capture_state(const SharedState* shm, StreamState* state) {
+    int num_gangs = shm->num_gangs;
+    if (num_gangs < 0) num_gangs = 0;
+    if (num_gangs > MAX_SHARED_GANGS) num_gangs = MAX_SHARED_GANGS;
+
+    for (int i = state->num_gangs; i < num_gangs; i++) {
+        memset(&state->gang_states[i], 0, sizeof(GangVisState));
+        state->gang_states[i].id = i;
+    }
+    state->num_gangs = num_gangs;
+
+    state->total_successful_missions = shm->total_successful_missions;
+    state->total_thwarted_missions = shm->total_thwarted_missions;
+    state->total_executed_agents = shm->total_executed_agents;
+    state->simulation_running = shm->simulation_running;
+
+    for (int i = 0; i < num_gangs; i++) {
+        GangVisState* gang = &state->gang_states[i];
+        GangVisRecord record;
+        if (read_gang_record(shm, i, &record)) {
+            gang->preparation_level = record.preparation_level;
+            gang->current_target = record.current_target;
+            gang->num_members = record.num_members;
+            gang->num_agents = record.num_agents;
+            gang->is_active = record.is_active;
+        }
+        gang->is_in_prison = shm->gang_status[i].is_arrested;
+        gang->prison_time_remaining = gang->is_in_prison ? shm->gang_status[i].prison_time : 0;
+    }
+}
+
+// Copy `source` into `target` - both have room for MAX_SHARED_GANGS gangs
+static void copy_state(StreamState* target, const StreamState* source) {
+    target->num_gangs = source->num_gangs;
+    target->total_successful_missions = source->total_successful_missions;
+    target->total_thwarted_missions = source->total_thwarted_missions;
+    target->total_executed_agents = source->total_executed_agents;
+    target->simulation_running = source->simulation_running;
+    memcpy(target->gang_states, source->gang_states, source->num_gangs * sizeof(GangVisState));
+}
+
+// Create the listening unix socket the stream is served on
+static int open_stream_socket(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("Failed to create stream socket");
+        return -1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    // Remove a socket left behind by a previous run
+    unlink(path);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, 8) == -1) {
+        perror("Failed to bind stream socket");
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// Disconnect a client and free its slot
+static void drop_client(StreamClient* client) {
+    close(client->fd);
+    client->fd = -1;
+    client->length = 0;
+    client->sent = 0;
+    client->resync = false;
+    client->stalled_since = 0;
+}
+
+// Queue a whole frame on a client if it fits within the backlog limit
+static bool queue_frame(StreamClient* client, const unsigned char* frame, size_t length, size_t capacity) {
+    // Reclaim the space of frames already written
+    if (client->sent > 0) {
+        memmove(client->pending, client->pending + client->sent, client->length - client->sent);
+        client->length -= client->sent;
+        client->sent = 0;
+    }
+
+    if (client->length + length > capacity) return false;
+    memcpy(client->pending + client->length, frame, length);
+    client->length += length;
+    return true;
+}
+
+// Write as much of a client's backlog as the socket takes without blocking
+static void flush_client(StreamClient* client, long long now) {
+    while (client->sent < client->length) {
+        ssize_t result = send(client->fd, client->pending + client->sent,
+                              client->length - client->sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (result > 0) {
+            client->sent += result;
+            client->stalled_since = 0;
+            continue;
+        }
+        if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (client->stalled_since == 0) client->stalled_since = now;
+            return;
+        }
+        if (result == -1 && errno == EINTR) continue;
+
+        drop_client(client);
+        return;
+    }
+
+    client->length = 0;
+    client->sent = 0;
+    client->stalled_since = 0;
+}
+
+// Accept waiting connections and greet each with a snapshot of `state`
+static void accept_clients(int listen_fd, StreamClient* clients, size_t capacity,
+                           const StreamState* state, StreamBuffer* frame, unsigned int tick) {
+    int client_fd;
+    while ((client_fd = accept(listen_fd, NULL, NULL)) != -1) {
+        StreamClient* client = NULL;
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            if (clients[i].fd == -1) {
+                client = &clients[i];
+                break;
+            }
+        }
+        if (client == NULL) {
+            close(client_fd);
+            continue;
+        }
+
+        fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+        client->fd = client_fd;
+        frame->length = 0;
+        if (!encode_snapshot(frame, state, tick) || !queue_frame(client, frame->data, frame->length, capacity)) {
+            drop_client(client);
+        }
+    }
+}
+
+// State stream process main function
+void run_state_stream(SimulationConfig config, SharedState* shm) {
+    signal(SIGINT, stream_signal_handler);
+    signal(SIGTERM, stream_signal_handler);
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = open_stream_socket(config.stream_socket);
+    if (listen_fd == -1) {
+        exit(1);
+    }
+
+    int interval_ms = config.stream_interval_ms > 0 ? config.stream_interval_ms : 100;
+    log_message("State stream serving %s every %d ms", config.stream_socket, interval_ms);
+
+    // A client holds at most one snapshot plus a bounded run of deltas
+    size_t capacity = STREAM_HEADER_SIZE + 32 + MAX_SHARED_GANGS * STREAM_MAX_GANG_BYTES + STREAM_CLIENT_BACKLOG;
+
+    StreamState previous = {0};
+    StreamState current = {0};
+    StreamBuffer frame = {0};
+    StreamClient clients[STREAM_MAX_CLIENTS];
+    previous.gang_states = (GangVisState*)calloc(MAX_SHARED_GANGS, sizeof(GangVisState));
+    current.gang_states = (GangVisState*)calloc(MAX_SHARED_GANGS, sizeof(GangVisState));
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].pending = (unsigned char*)malloc(capacity);
+        clients[i].length = 0;
+        clients[i].sent = 0;
+        clients[i].resync = false;
+        clients[i].stalled_since = 0;
+        if (clients[i].pending == NULL) {
+            perror("Failed to allocate stream buffers");
+            exit(1);
+        }
+    }
+    if (previous.gang_states == NULL || current.gang_states == NULL) {
+        perror("Failed to allocate stream buffers");
+        exit(1);
+    }
+
+    unsigned int tick = 0;
+    capture_state(shm, &previous);
+    copy_state(&current, &previous);
+    long long next_tick = monotonic_time_us() + interval_ms * 1000LL;
+
+    while (stream_running) {
+        long long now = monotonic_time_us();
+
+        if (now >= next_tick) {
+            tick++;
+            capture_state(shm, &current);
+
+            frame.length = 0;
+            bool has_delta = encode_delta(&frame, &previous, &current, tick);
+
+            for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+                StreamClient* client = &clients[i];
+                if (client->fd == -1) continue;
+
+                if (client->stalled_since != 0 && now - client->stalled_since > STREAM_STALL_TIMEOUT_MS * 1000LL) {
+                    log_message("State stream dropped a client that stopped reading");
+                    drop_client(client);
+                    continue;
+                }
+
+                if (client->resync) {
+                    // Missed deltas collapse into one snapshot once the backlog is gone
+                    if (client->sent < client->length) continue;
+                    StreamBuffer snapshot = {0};
+                    if (encode_snapshot(&snapshot, &current, tick) &&
+                        queue_frame(client, snapshot.data, snapshot.length, capacity)) {
+                        client->resync = false;
+                    }
+                    free(snapshot.data);
+                }
+                else if (has_delta && !queue_frame(client, frame.data, frame.length, capacity)) {
+                    client->resync = true;
+                }
+            }
+
+            copy_state(&previous, &current);
+            next_tick += interval_ms * 1000LL;
+            if (next_tick < now) next_tick = now + interval_ms * 1000LL;
+        }
+
+        // Wait for new connections, writable clients or the next tick
+        struct pollfd pfds[STREAM_MAX_CLIENTS + 1];
+        int slots[STREAM_MAX_CLIENTS + 1];
+        int nfds = 0;
+        pfds[nfds].fd = listen_fd;
+        pfds[nfds].events = POLLIN;
+        slots[nfds++] = -1;
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            if (clients[i].fd == -1) continue;
+            pfds[nfds].fd = clients[i].fd;
+            pfds[nfds].events = POLLIN | (clients[i].sent < clients[i].length ? POLLOUT : 0);
+            slots[nfds++] = i;
+        }
+
+        int timeout_ms = (int)((next_tick - monotonic_time_us()) / 1000);
+        if (timeout_ms < 0) timeout_ms = 0;
+        if (poll(pfds, nfds, timeout_ms) <= 0) continue;
+
+        now = monotonic_time_us();
+        for (int p = 1; p < nfds; p++) {
+            StreamClient* client = &clients[slots[p]];
+            if (pfds[p].revents & (POLLHUP | POLLERR)) {
+                drop_client(client);
+                continue;
+            }
+            if (pfds[p].revents & POLLIN) {
+                // Clients have nothing to say - anything read is discarded, EOF disconnects
+                char discard[256];
+                ssize_t result = recv(client->fd, discard, sizeof(discard), MSG_DONTWAIT);
+                if (result == 0 || (result == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    drop_client(client);
+                    continue;
+                }
+            }
+            if (pfds[p].revents & POLLOUT) {
+                flush_client(client, now);
+            }
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            accept_clients(listen_fd, clients, capacity, &previous, &frame, tick);
+        }
+    }
+
+    // Cleanup
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].fd != -1) close(clients[i].fd);
+        free(clients[i].pending);
+    }
+    close(listen_fd);
+    unlink(config.stream_socket);
+    free(frame.data);
+    free(previous.gang_states);
+    free(current.gang_states);
+    exit(0);
+}
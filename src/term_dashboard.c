@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include "../include/term_dashboard.h"
+#include "../include/utils.h"
+#include "../include/lock_profile.h"
+
+// Cell colors
+typedef enum {
+    COLOR_DEFAULT,
+    COLOR_HEADER,     // Inverse video title bar
+    COLOR_DIM,
+    COLOR_GREEN,
+    COLOR_YELLOW,
+    COLOR_RED,
+    COLOR_CYAN,
+    COLOR_BOLD,
+    NUM_COLORS
+} CellColor;
+
+static const char* color_sequences[NUM_COLORS] = {
+    "\033[0m", "\033[0;7m", "\033[0;2m", "\033[0;32m",
+    "\033[0;33m", "\033[0;31m", "\033[0;36m", "\033[0;1m"
+};
+
+// One character cell on screen
+typedef struct {
+    char ch;                  // 0 marks a cell whose on-screen content is unknown
+    unsigned char color;
+} Cell;
+
+// Sort columns
+typedef enum {
+    SORT_BY_ID,
+    SORT_BY_PREPARATION,
+    SORT_BY_STATUS,
+    SORT_BY_MEMBERS,
+    NUM_SORT_MODES
+} SortMode;
+
+static const char* sort_names[NUM_SORT_MODES] = { "id", "preparation", "status", "members" };
+
+// Rows above and below the gang table
+#define HEADER_ROWS 4
+
+// Preparation history column: position and buckets shown
+#define HISTORY_COLUMN 91
+#define HISTORY_COLUMNS 30
+#define FOOTER_ROWS 1
+
+// Dashboard state - only touched by the visualization thread, except
+// start/stop which take term_mutex so the terminal is never restored mid-frame
+static pthread_mutex_t term_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool active = false;
+static pid_t owner_pid = -1;          // Forked children inherit atexit handlers
+static int term_fd = -1;              // The terminal, duplicated before stdout is redirected
+static bool have_termios = false;
+static struct termios saved_termios;
+
+static int screen_rows = 0;
+static int screen_cols = 0;
+static Cell* front_cells = NULL;      // What the terminal currently shows
+static Cell* back_cells = NULL;       // Frame being composed
+
+static char* out_buffer = NULL;       // Escape sequences for one frame
+static size_t out_length = 0;
+static size_t out_capacity = 0;
+
+static int* order = NULL;             // Gang indices in display order
+static int order_capacity = 0;
+static unsigned int sorted_sequence = 0;
+static SortMode sort_mode = SORT_BY_ID;
+static bool sort_reverse = false;
+static bool resort = true;
+static int scroll_top = 0;
+static int table_rows = 1;
+static int num_rows_total = 0;
+
+// Append bytes to the frame output
+static void out_append(const char* data, size_t length) {
+    if (out_length + length > out_capacity) {
+        size_t capacity = out_capacity ? out_capacity : 4096;
+        while (capacity < out_length + length) capacity *= 2;
+        char* buffer = (char*)realloc(out_buffer, capacity);
+        if (!buffer) return;
+        out_buffer = buffer;
+        out_capacity = capacity;
+    }
+    memcpy(out_buffer + out_length, data, length);
+    out_length += length;
+}
+
+static void out_string(const char* text) {
+    out_append(text, strlen(text));
+}
+
+// Write the whole frame to the terminal with as few syscalls as possible
+static void out_flush() {
+    size_t written = 0;
+    while (written < out_length) {
+        ssize_t result = write(term_fd, out_buffer + written, out_length - written);
+        if (result <= 0) break;
+        written += result;
+    }
+    out_length = 0;
+}
+
+// Track the terminal size; on change every cell must be repainted
+static void update_screen_size() {
+    struct winsize size;
+    int rows = 24;
+    int cols = 80;
+    if (ioctl(term_fd, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        rows = size.ws_row;
+        cols = size.ws_col;
+    }
+    if (rows == screen_rows && cols == screen_cols && front_cells != NULL) return;
+
+    Cell* front = (Cell*)calloc(rows * cols, sizeof(Cell));
+    Cell* back = (Cell*)calloc(rows * cols, sizeof(Cell));
+    if (!front || !back) {
+        free(front);
+        free(back);
+        return;
+    }
+    free(front_cells);
+    free(back_cells);
+    front_cells = front;    // All zero: nothing on screen is known
+    back_cells = back;
+    screen_rows = rows;
+    screen_cols = cols;
+
+    table_rows = screen_rows - HEADER_ROWS - FOOTER_ROWS;
+    if (table_rows < 1) table_rows = 1;
+
+    out_string("\033[0m\033[2J");
+}
+
+// Put text into the back buffer, clipped to the screen
+static void put_text(int row, int col, CellColor color, const char* text) {
+    if (row < 0 || row >= screen_rows) return;
+    Cell* line = &back_cells[row * screen_cols];
+    for (; *text && col < screen_cols; text++, col++) {
+        if (col < 0) continue;
+        line[col].ch = *text;
+        line[col].color = color;
+    }
+}
+
+// Fill a whole row of the back buffer with one color
+static void fill_row(int row, CellColor color) {
+    Cell* line = &back_cells[row * screen_cols];
+    for (int col = 0; col < screen_cols; col++) {
+        line[col].ch = ' ';
+        line[col].color = color;
+    }
+}
+
+// Emit the cells that differ from what is on screen, then swap the buffers
+static void emit_diff() {
+    int cursor_row = -1;
+    int cursor_col = -1;
+    int current_color = -1;
+    char move[32];
+
+    for (int row = 0; row < screen_rows; row++) {
+        for (int col = 0; col < screen_cols; col++) {
+            Cell* cell = &back_cells[row * screen_cols + col];
+            Cell* shown = &front_cells[row * screen_cols + col];
+            if (cell->ch == shown->ch && cell->color == shown->color) continue;
+
+            // Skip the cursor move when the previous change was the cell to the left
+            if (row != cursor_row || col != cursor_col) {
+                snprintf(move, sizeof(move), "\033[%d;%dH", row + 1, col + 1);
+                out_string(move);
+            }
+            if (cell->color != current_color) {
+                out_string(color_sequences[cell->color]);
+                current_color = cell->color;
+            }
+            out_append(&cell->ch, 1);
+            *shown = *cell;
+            cursor_row = row;
+            cursor_col = col + 1;
+        }
+    }
+    if (current_color != -1) out_string(color_sequences[COLOR_DEFAULT]);
+}
+
+// Sort key for the status column: free gangs first, then imprisoned, then dismantled
+static int status_rank(const GangVisState* gang) {
+    if (!gang->is_active) return 2;
+    return gang->is_in_prison ? 1 : 0;
+}
+
+static const VisSnapshot* sort_snapshot = NULL;
+
+static int compare_gangs(const void* a, const void* b) {
+    const GangVisState* ga = &sort_snapshot->gang_states[*(const int*)a];
+    const GangVisState* gb = &sort_snapshot->gang_states[*(const int*)b];
+    int result = 0;
+    switch (sort_mode) {
+        case SORT_BY_PREPARATION: result = gb->preparation_level - ga->preparation_level; break;
+        case SORT_BY_STATUS:      result = status_rank(ga) - status_rank(gb); break;
+        case SORT_BY_MEMBERS:     result = gb->num_members - ga->num_members; break;
+        default:                  break;
+    }
+    if (result == 0) result = ga->id - gb->id;
+    return sort_reverse ? -result : result;
+}
+
+// Rebuild the display order when the data or the sort settings changed
+static void update_order(const VisSnapshot* snapshot) {
+    if (snapshot->num_gangs > order_capacity) {
+        int* grown = (int*)realloc(order, snapshot->num_gangs * sizeof(int));
+        if (!grown) return;
+        order = grown;
+        order_capacity = snapshot->num_gangs;
+        resort = true;
+    }
+    if (!resort && snapshot->sequence == sorted_sequence && num_rows_total == snapshot->num_gangs) return;
+
+    num_rows_total = snapshot->num_gangs;
+    for (int i = 0; i < num_rows_total; i++) order[i] = i;
+    if (sort_mode != SORT_BY_ID || sort_reverse) {
+        sort_snapshot = snapshot;
+        qsort(order, num_rows_total, sizeof(int), compare_gangs);
+    }
+    sorted_sequence = snapshot->sequence;
+    resort = false;
+}
+
+// Keep the scroll position inside the table
+static void clamp_scroll() {
+    int max_top = num_rows_total - table_rows;
+    if (scroll_top > max_top) scroll_top = max_top;
+    if (scroll_top < 0) scroll_top = 0;
+}
+
+// Draw one gang as a table row
+static void draw_gang_row(int row, const GangVisState* gang) {
+    char text[64];
+
+    snprintf(text, sizeof(text), "%6d", gang->id);
+    put_text(row, 0, COLOR_DEFAULT, text);
+
+    if (!gang->is_active) {
+        put_text(row, 8, COLOR_RED, "Dismantled");
+    } else if (gang->is_in_prison) {
+        put_text(row, 8, COLOR_YELLOW, "Imprisoned");
+    } else {
+        put_text(row, 8, COLOR_GREEN, "Active");
+    }
+
+    // Preparation percentage and bar, colored like the GL progress bars
+    int level = gang->preparation_level;
+    if (level < 0) level = 0;
+    if (level > 100) level = 100;
+    snprintf(text, sizeof(text), "%3d%%", level);
+    put_text(row, 20, COLOR_DEFAULT, text);
+
+    CellColor bar_color = level < 50 ? COLOR_DIM : (level < 80 ? COLOR_YELLOW : COLOR_RED);
+    char bar[23];
+    int filled = level / 5;
+    bar[0] = '[';
+    for (int i = 0; i < 20; i++) bar[i + 1] = i < filled ? '#' : '.';
+    bar[21] = ']';
+    bar[22] = '\0';
+    put_text(row, 25, bar_color, bar);
+
+    put_text(row, 49, COLOR_DEFAULT, crime_type_to_string(gang->current_target));
+
+    snprintf(text, sizeof(text), "%7d %6d", gang->num_members, gang->num_agents);
+    put_text(row, 68, COLOR_DEFAULT, text);
+
+    if (gang->is_in_prison) {
+        snprintf(text, sizeof(text), "%6d", gang->prison_time_remaining);
+        put_text(row, 83, COLOR_YELLOW, text);
+    }
+}
+
+// Preparation history of one gang as a character ramp, newest bucket rightmost;
+// buckets that include an arrest are yellow
+static void draw_history(int row, const VisSnapshot* snapshot, int gang_index) {
+    static const char ramp[] = "_.-=+*#@";
+    if (!snapshot->has_history[gang_index]) return;
+
+    const HistoryBucket* buckets = &snapshot->history[(size_t)gang_index * HISTORY_METRICS * HISTORY_BUCKETS];
+    const HistoryBucket* prep = &buckets[HISTORY_PREPARATION * HISTORY_BUCKETS];
+    const HistoryBucket* arrested = &buckets[HISTORY_ARRESTED * HISTORY_BUCKETS];
+
+    for (int i = 0; i < HISTORY_COLUMNS; i++) {
+        int b = HISTORY_BUCKETS - HISTORY_COLUMNS + i;
+        if (prep[b].count == 0) continue;
+
+        int level = prep[b].sum / prep[b].count;
+        if (level < 0) level = 0;
+        if (level > 100) level = 100;
+        char ch[2] = { ramp[level * (int)(sizeof(ramp) - 2) / 100], '\0' };
+        put_text(row, HISTORY_COLUMN + i, arrested[b].max > 0 ? COLOR_YELLOW : COLOR_CYAN, ch);
+    }
+}
+
+// Compose and emit one frame
+void term_dashboard_draw(const VisSnapshot* snapshot, const SimulationConfig* config) {
+    sim_mutex_lock(&term_mutex);
+    if (!active || snapshot == NULL) {
+        sim_mutex_unlock(&term_mutex);
+        return;
+    }
+
+    update_screen_size();
+    update_order(snapshot);
+    clamp_scroll();
+
+    for (int row = 0; row < screen_rows; row++) {
+        fill_row(row, row == 0 ? COLOR_HEADER : COLOR_DEFAULT);
+    }
+
+    // Title bar
+    char text[256];
+    time_t now = time(NULL);
+    struct tm* timeinfo = localtime(&now);
+    snprintf(text, sizeof(text), " Crime Simulation | %d gangs | %s | sort: %s%s | %02d:%02d:%02d",
+             snapshot->num_gangs, snapshot->simulation_running ? "Running" : "Stopped",
+             sort_names[sort_mode], sort_reverse ? " (reversed)" : "",
+             timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+    put_text(0, 0, COLOR_HEADER, text);
+
+    // Counters
+    snprintf(text, sizeof(text), "Succeeded %d/%d", snapshot->total_successful_missions, config->max_successful_plans);
+    put_text(1, 1, COLOR_YELLOW, text);
+    snprintf(text, sizeof(text), "Thwarted %d/%d", snapshot->total_thwarted_missions, config->max_thwarted_plans);
+    put_text(1, 24, COLOR_CYAN, text);
+    snprintf(text, sizeof(text), "Agents executed %d/%d", snapshot->total_executed_agents, config->max_executed_agents);
+    put_text(1, 46, COLOR_RED, text);
+
+    // Table header
+    put_text(3, 0, COLOR_BOLD, "  GANG  STATUS      PREP [PROGRESS            ]  TARGET             MEMBERS AGENTS PRISON");
+    char span[16];
+    history_span_label(snapshot->history_level, span, sizeof(span));
+    snprintf(text, sizeof(text), "PREP HISTORY (%s)", span);
+    put_text(3, HISTORY_COLUMN, COLOR_BOLD, text);
+
+    // Only the visible rows are drawn
+    for (int i = 0; i < table_rows && scroll_top + i < num_rows_total; i++) {
+        draw_gang_row(HEADER_ROWS + i, &snapshot->gang_states[order[scroll_top + i]]);
+        draw_history(HEADER_ROWS + i, snapshot, order[scroll_top + i]);
+    }
+
+    // Footer
+    int last_shown = scroll_top + table_rows < num_rows_total ? scroll_top + table_rows : num_rows_total;
+    snprintf(text, sizeof(text), " j/k scroll  PgUp/PgDn page  g/G top/bottom  s sort  r reverse  l history  q quit   rows %d-%d of %d",
+             num_rows_total > 0 ? scroll_top + 1 : 0, last_shown, num_rows_total);
+    put_text(screen_rows - 1, 0, COLOR_DIM, text);
+
+    emit_diff();
+    out_flush();
+    sim_mutex_unlock(&term_mutex);
+}
+
+// Apply one key press; returns true if the view changed
+static bool handle_key(const char* keys, int length, int* consumed) {
+    *consumed = 1;
+    int previous_top = scroll_top;
+
+    if (keys[0] == '\033' && length >= 3 && keys[1] == '[') {
+        *consumed = 3;
+        switch (keys[2]) {
+            case 'A': scroll_top--; break;
+            case 'B': scroll_top++; break;
+            case 'H': scroll_top = 0; break;
+            case 'F': scroll_top = num_rows_total; break;
+            case '5': case '6':
+                if (length >= 4 && keys[3] == '~') {
+                    *consumed = 4;
+                    scroll_top += keys[2] == '5' ? -table_rows : table_rows;
+                }
+                break;
+        }
+    } else {
+        switch (keys[0]) {
+            case 'k': scroll_top--; break;
+            case 'j': scroll_top++; break;
+            case 'g': scroll_top = 0; break;
+            case 'G': scroll_top = num_rows_total; break;
+            case 's':
+                sort_mode = (sort_mode + 1) % NUM_SORT_MODES;
+                resort = true;
+                return true;
+            case 'r':
+                sort_reverse = !sort_reverse;
+                resort = true;
+                return true;
+            case 'l':
+                visualization_cycle_history_level();
+                return true;
+            case 'q':
+                kill(getpid(), SIGINT);
+                return false;
+        }
+    }
+
+    clamp_scroll();
+    return scroll_top != previous_top;
+}
+
+// Wait up to timeout_ms for key presses; returns true if the view changed
+bool term_dashboard_wait_input(int timeout_ms) {
+    if (!active || !have_termios) {
+        usleep(timeout_ms * 1000);
+        return false;
+    }
+
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    if (poll(&pfd, 1, timeout_ms) <= 0) return false;
+
+    char keys[64];
+    ssize_t length = read(STDIN_FILENO, keys, sizeof(keys));
+    bool changed = false;
+    for (int i = 0; i < length; ) {
+        int consumed;
+        changed |= handle_key(keys + i, length - i, &consumed);
+        i += consumed;
+    }
+    return changed;
+}
+
+// Restore the terminal (only in the process that took it over)
+void term_dashboard_stop() {
+    if (getpid() != owner_pid) return;
+
+    sim_mutex_lock(&term_mutex);
+    if (active) {
+        active = false;
+        // Show the cursor again and leave the alternate screen
+        out_string("\033[0m\033[?25h\033[?1049l");
+        out_flush();
+        if (have_termios) {
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        }
+    }
+    sim_mutex_unlock(&term_mutex);
+}
+
+// Take over the terminal; false if stdout is not a terminal.
+// With a NULL log file stdout and stderr stay on the terminal (the caller stays quiet).
+bool term_dashboard_start(const char* log_file) {
+    if (!isatty(STDOUT_FILENO)) return false;
+
+    int log_fd = -1;
+    if (log_file != NULL) {
+        log_fd = open(log_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log_fd == -1) {
+            perror("Failed to open dashboard log file");
+            return false;
+        }
+    }
+
+    term_fd = dup(STDOUT_FILENO);
+    if (term_fd == -1) {
+        perror("Failed to duplicate terminal descriptor");
+        if (log_fd != -1) close(log_fd);
+        return false;
+    }
+
+    // Everything every process prints goes to the log from now on
+    if (log_fd != -1) {
+        fflush(stdout);
+        fflush(stderr);
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+        close(log_fd);
+        setvbuf(stdout, NULL, _IOLBF, 0);
+    }
+
+    // Keys arrive one at a time without echo; Ctrl-C still raises SIGINT
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved_termios) == 0) {
+        struct termios raw = saved_termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        have_termios = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+
+    owner_pid = getpid();
+    active = true;
+    atexit(term_dashboard_stop);
+
+    // Alternate screen, hidden cursor
+    out_string("\033[?1049h\033[?25l\033[2J");
+    out_flush();
+    return true;
+}
+
+// Whether the terminal dashboard owns the terminal
+bool term_dashboard_active() {
+    return active;
+}
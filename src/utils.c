@@ -1,12 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <time.h>
 #include <sys/time.h>
 #include <stdbool.h>
 #include "../include/utils.h"
 #include "../include/config.h"
+#include "../include/metrics.h"
+
+// Alignment of everything an arena hands out
+#define ARENA_ALIGN 16
+
+// Header in front of an arena spill block or a pool slab, keeps the payload aligned
+typedef union MemoryBlock {
+    union MemoryBlock* next;
+    max_align_t align;
+} MemoryBlock;
 
 // Generate a random integer between min and max (inclusive)
 int random_int(int min, int max) {
@@ -31,6 +42,13 @@ void delay_ms(int milliseconds) {
     nanosleep(&ts, NULL);
 }
 
+// Current monotonic time in microseconds (for measuring durations)
+long long monotonic_time_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
 // Log a message with timestamp
 void log_message(const char* format, ...) {
     // Get current time
@@ -73,3 +91,144 @@ const char* crime_type_to_string(CrimeType type) {
             return "Unknown Crime";
     }
 }
+
+// Crimes the police respond to before any other
+bool crime_is_high_risk(CrimeType type) {
+    return type == KIDNAPPING || type == BANK_ROBBERY || type == ARM_TRAFFICKING;
+}
+
+// Set up an arena with room for `capacity` bytes per round (0 defers the first block to a spill)
+bool arena_init(Arena* arena, size_t capacity) {
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+    arena->round_size = 0;
+    arena->spills = NULL;
+    if (capacity == 0) return true;
+
+    arena->base = (char*)malloc(capacity);
+    if (arena->base == NULL) {
+        perror("Failed to allocate arena");
+        return false;
+    }
+    METRICS_INC(scratch_heap_allocations);
+    arena->capacity = capacity;
+    return true;
+}
+
+// Hand out `size` bytes, valid until the next arena_reset; NULL if the heap is exhausted
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    arena->round_size += size;
+
+    if (arena->used + size <= arena->capacity) {
+        void* memory = arena->base + arena->used;
+        arena->used += size;
+        METRICS_INC(scratch_allocations_avoided);
+        return memory;
+    }
+
+    // Does not fit this round - spill to the heap until the next reset
+    MemoryBlock* block = (MemoryBlock*)malloc(sizeof(MemoryBlock) + size);
+    if (block == NULL) {
+        perror("Failed to allocate arena spill");
+        return NULL;
+    }
+    METRICS_INC(scratch_heap_allocations);
+    block->next = (MemoryBlock*)arena->spills;
+    arena->spills = block;
+    return block + 1;
+}
+
+// Release everything handed out since the last reset
+void arena_reset(Arena* arena) {
+    if (arena->spills != NULL) {
+        MemoryBlock* block = (MemoryBlock*)arena->spills;
+        while (block != NULL) {
+            MemoryBlock* next = block->next;
+            free(block);
+            block = next;
+        }
+        arena->spills = NULL;
+
+        // Grow to what the round needed; the old contents are dead anyway
+        char* base = (char*)malloc(arena->round_size);
+        if (base != NULL) {
+            METRICS_INC(scratch_heap_allocations);
+            free(arena->base);
+            arena->base = base;
+            arena->capacity = arena->round_size;
+        }
+    }
+    arena->used = 0;
+    arena->round_size = 0;
+}
+
+// Free an arena's memory
+void arena_destroy(Arena* arena) {
+    arena_reset(arena);
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+}
+
+// Set up an empty pool of `object_size` records, added `objects_per_slab` at a time
+void pool_init(ObjectPool* pool, size_t object_size, int objects_per_slab) {
+    // Free records hold the free-list link
+    if (object_size < sizeof(void*)) object_size = sizeof(void*);
+    pool->object_size = (object_size + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+    pool->objects_per_slab = objects_per_slab > 0 ? objects_per_slab : 1;
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->in_use = 0;
+}
+
+// Take a record from the pool, adding a slab when it is empty; NULL if the heap is exhausted
+void* pool_get(ObjectPool* pool) {
+    if (pool->free_list == NULL) {
+        MemoryBlock* slab = (MemoryBlock*)malloc(sizeof(MemoryBlock) + pool->object_size * pool->objects_per_slab);
+        if (slab == NULL) {
+            perror("Failed to allocate pool slab");
+            return NULL;
+        }
+        METRICS_INC(scratch_heap_allocations);
+        slab->next = (MemoryBlock*)pool->slabs;
+        pool->slabs = slab;
+
+        // Thread the new records onto the free list
+        char* objects = (char*)(slab + 1);
+        for (int i = pool->objects_per_slab - 1; i >= 0; i--) {
+            void* object = objects + i * pool->object_size;
+            *(void**)object = pool->free_list;
+            pool->free_list = object;
+        }
+    }
+    else {
+        METRICS_INC(scratch_allocations_avoided);
+    }
+
+    void* object = pool->free_list;
+    pool->free_list = *(void**)object;
+    pool->in_use++;
+    return object;
+}
+
+// Give a record back to its pool
+void pool_put(ObjectPool* pool, void* object) {
+    *(void**)object = pool->free_list;
+    pool->free_list = object;
+    pool->in_use--;
+}
+
+// Free every slab of a pool, whether or not its records were given back
+void pool_destroy(ObjectPool* pool) {
+    MemoryBlock* slab = (MemoryBlock*)pool->slabs;
+    while (slab != NULL) {
+        MemoryBlock* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->in_use = 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "../include/visualization.h"
+
+// Triple buffering: the producer owns one buffer, the consumer owns one, and
+// the third sits in the shared `middle` slot. Publishing and acquiring are a
+// single atomic exchange each, so neither side ever waits for the other.
+#define SNAPSHOT_BUFFERS 3
+#define SNAPSHOT_INDEX_MASK 0x3
+#define SNAPSHOT_FRESH 0x4    // Middle slot holds a snapshot the consumer has not taken yet
+
+static VisSnapshot snapshots[SNAPSHOT_BUFFERS];
+static atomic_int middle_slot = 1;
+static int back_index = 0;            // Producer side
+static int front_index = 2;           // Consumer side
+static bool front_valid = false;      // Consumer has taken at least one snapshot
+static unsigned int publish_sequence = 0;
+
+// Allocate the snapshot buffers for the given number of gangs
+bool vis_snapshot_init(int num_gangs) {
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        snapshots[i].gang_states = (GangVisState*)calloc(num_gangs, sizeof(GangVisState));
+        snapshots[i].member_counts = (int*)malloc(num_gangs * sizeof(int));
+        snapshots[i].members = (GangMemberRecord*)calloc((size_t)num_gangs * MAX_SHARED_MEMBERS, sizeof(GangMemberRecord));
+        snapshots[i].has_history = (bool*)calloc(num_gangs, sizeof(bool));
+        snapshots[i].history = (HistoryBucket*)calloc((size_t)num_gangs * HISTORY_METRICS * HISTORY_BUCKETS,
+                                                      sizeof(HistoryBucket));
+        if (snapshots[i].gang_states == NULL || snapshots[i].member_counts == NULL || snapshots[i].members == NULL ||
+            snapshots[i].has_history == NULL || snapshots[i].history == NULL) {
+            perror("Failed to allocate visualization snapshot");
+            vis_snapshot_cleanup();
+            return false;
+        }
+        snapshots[i].num_gangs = num_gangs;
+        for (int j = 0; j < num_gangs; j++) {
+            snapshots[i].member_counts[j] = -1;
+        }
+    }
+    
+    atomic_store(&middle_slot, 1);
+    back_index = 0;
+    front_index = 2;
+    front_valid = false;
+    publish_sequence = 0;
+    return true;
+}
+
+// Free the snapshot buffers
+void vis_snapshot_cleanup() {
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        free(snapshots[i].gang_states);
+        free(snapshots[i].member_counts);
+        free(snapshots[i].members);
+        free(snapshots[i].has_history);
+        free(snapshots[i].history);
+        snapshots[i].gang_states = NULL;
+        snapshots[i].member_counts = NULL;
+        snapshots[i].members = NULL;
+        snapshots[i].has_history = NULL;
+        snapshots[i].history = NULL;
+        snapshots[i].num_gangs = 0;
+    }
+}
+
+// Buffer the producer fills before publishing (NULL if not initialized)
+VisSnapshot* vis_snapshot_back_buffer() {
+    VisSnapshot* snapshot = &snapshots[back_index];
+    return snapshot->gang_states != NULL ? snapshot : NULL;
+}
+
+// Hand the filled back buffer to the consumer and take a free one in exchange
+void vis_snapshot_publish() {
+    snapshots[back_index].sequence = ++publish_sequence;
+    int previous = atomic_exchange_explicit(&middle_slot, back_index | SNAPSHOT_FRESH, memory_order_acq_rel);
+    back_index = previous & SNAPSHOT_INDEX_MASK;
+}
+
+// Newest published snapshot; stays valid until the next call (NULL before the first publish)
+const VisSnapshot* vis_snapshot_acquire() {
+    if (atomic_load_explicit(&middle_slot, memory_order_relaxed) & SNAPSHOT_FRESH) {
+        int previous = atomic_exchange_explicit(&middle_slot, front_index, memory_order_acq_rel);
+        front_index = previous & SNAPSHOT_INDEX_MASK;
+        front_valid = true;
+    }
+    
+    if (!front_valid || snapshots[front_index].gang_states == NULL) return NULL;
+    return &snapshots[front_index];
+}
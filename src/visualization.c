@@ -12,9 +12,12 @@
 #include "../include/police.h"
 #include "../include/utils.h"
 #include "../include/ipc.h"
+#include "../include/lock_profile.h"
+#include "../include/render_batch.h"
+#include "../include/term_dashboard.h"
 
-// Global visualization context is declared as extern in the header
-// No need to redefine it here
+// Global visualization context (declared extern in the header)
+VisualizationContext viz_context;
 
 // F-2: Track which gang expand button is being hovered over
 int hover_gang_index = -1;
@@ -23,6 +26,38 @@ int hover_gang_index = -1;
 int mouse_x = 0;
 int mouse_y = 0;
 
+// Change-driven redraw: the timer backs off up to this interval while nothing changes
+#define VIZ_MAX_IDLE_INTERVAL_MS 1000
+
+static int redraw_interval_ms = 0;        // Current timer interval
+static unsigned int drawn_version = 0;    // State version of the last posted redraw
+static time_t drawn_clock = 0;            // Status bar clock of the last posted redraw
+
+// Dashboard layout - shared by drawing and hit testing so both agree on positions
+#define LEFT_COLUMN_FRACTION 0.25f     // Gang list
+#define CENTER_COLUMN_FRACTION 0.5f    // Current operations
+#define PANEL_HEIGHT_FRACTION 0.9f     // Panels stop below the status bar
+
+#define GANG_ROW_HEIGHT 40             // Collapsed gang list entry
+#define GANG_EXPANDED_ROW_HEIGHT 120   // Gang list entry showing the member table
+#define MEMBER_ROWS_SHOWN 4            // Member table rows that fit an expanded entry
+#define GANG_LIST_FIRST_ROW 70         // First gang row center, below the panel top
+#define TARGET_ROW_HEIGHT 90           // Current operations entry
+#define TARGET_LIST_FIRST_ROW 90       // First operations row, below the panel top
+#define LIST_BOTTOM_MARGIN 20          // Rows are drawn while they stay above this margin
+
+// Virtualized gang list: a Fenwick tree over the row heights gives the offset of
+// any row and the row at any offset in O(log n), and plain index arithmetic while
+// every gang is collapsed, so the list never walks rows that are off screen
+typedef struct {
+    int* tree;          // Fenwick tree (1-based) over row heights
+    int* height;        // Current height of each row
+    int size;           // Number of rows
+    int num_expanded;   // Rows currently expanded
+} GangRowIndex;
+
+static GangRowIndex gang_rows = {NULL, NULL, 0, 0};
+
 // Colors for different entities (expanded to handle more than 7 gangs)
 float gang_colors[][3] = {
     {1.0f, 0.0f, 0.0f},  // Red
@@ -37,6 +72,125 @@ float gang_colors[][3] = {
     {0.9f, 0.6f, 0.3f}   // Peach
 };
 
+// Rebuild the gang row index with every gang collapsed or expanded
+static void gang_rows_reset(int num_gangs, bool expanded) {
+    if (gang_rows.size != num_gangs) {
+        free(gang_rows.tree);
+        free(gang_rows.height);
+        gang_rows.tree = (int*)calloc(num_gangs + 1, sizeof(int));
+        gang_rows.height = (int*)calloc(num_gangs, sizeof(int));
+        gang_rows.size = num_gangs;
+        if (!gang_rows.tree || !gang_rows.height) {
+            fprintf(stderr, "Error: Failed to allocate memory for the gang row index\n");
+            free(gang_rows.tree);
+            free(gang_rows.height);
+            gang_rows.tree = NULL;
+            gang_rows.height = NULL;
+            gang_rows.size = 0;
+        }
+    }
+    
+    int row_height = expanded ? GANG_EXPANDED_ROW_HEIGHT : GANG_ROW_HEIGHT;
+    for (int i = 1; i <= gang_rows.size; i++) {
+        gang_rows.tree[i] = row_height;
+    }
+    // Linear-time Fenwick build: push each partial sum to its parent
+    for (int i = 1; i <= gang_rows.size; i++) {
+        gang_rows.height[i - 1] = row_height;
+        int parent = i + (i & -i);
+        if (parent <= gang_rows.size) {
+            gang_rows.tree[parent] += gang_rows.tree[i];
+        }
+    }
+    gang_rows.num_expanded = expanded ? gang_rows.size : 0;
+}
+
+// Change the height of one gang row
+static void gang_rows_set_expanded(int row, bool expanded) {
+    if (row < 0 || row >= gang_rows.size) return;
+    
+    int row_height = expanded ? GANG_EXPANDED_ROW_HEIGHT : GANG_ROW_HEIGHT;
+    int delta = row_height - gang_rows.height[row];
+    if (delta == 0) return;
+    
+    gang_rows.height[row] = row_height;
+    gang_rows.num_expanded += expanded ? 1 : -1;
+    for (int i = row + 1; i <= gang_rows.size; i += i & -i) {
+        gang_rows.tree[i] += delta;
+    }
+}
+
+// Total height of the rows above `row`
+static int gang_rows_offset(int row) {
+    if (row > gang_rows.size) row = gang_rows.size;
+    if (gang_rows.num_expanded == 0) return row * GANG_ROW_HEIGHT;
+    
+    int offset = 0;
+    for (int i = row; i > 0; i -= i & -i) {
+        offset += gang_rows.tree[i];
+    }
+    return offset;
+}
+
+// Row containing the given offset from the top of the list (size when past the end)
+static int gang_rows_find(int offset) {
+    if (gang_rows.num_expanded == 0) {
+        int row = offset / GANG_ROW_HEIGHT;
+        return row < gang_rows.size ? row : gang_rows.size;
+    }
+    
+    // Descend the Fenwick tree, skipping whole blocks that end above the offset
+    int row = 0;
+    int step = 1;
+    while (step * 2 <= gang_rows.size) step *= 2;
+    for (; step > 0; step /= 2) {
+        if (row + step <= gang_rows.size && gang_rows.tree[row + step] <= offset) {
+            row += step;
+            offset -= gang_rows.tree[row];
+        }
+    }
+    return row;
+}
+
+// Expand or collapse one gang (caller holds the viz mutex)
+static void set_gang_expanded(int gang_index, bool expanded) {
+    if (viz_context.expanded_gangs == NULL) return;
+    viz_context.expanded_gangs[gang_index] = expanded;
+    gang_rows_set_expanded(gang_index, expanded);
+    atomic_fetch_add(&viz_context.expansion_version, 1);
+}
+
+// Gang whose expand button is under window position (x, y), or -1
+static int gang_button_at(int x, int y) {
+    int window_width = viz_context.window_width;
+    int window_height = viz_context.window_height;
+    int panel_width = window_width * LEFT_COLUMN_FRACTION;
+    int panel_height = window_height * PANEL_HEIGHT_FRACTION;
+    int gl_y = window_height - y;
+    
+    // Buttons are 20x20, at the right edge of the panel, centered on their row
+    if (x < panel_width - 25 || x > panel_width - 5) return -1;
+    
+    int first_row_y = panel_height - GANG_LIST_FIRST_ROW;
+    int offset = first_row_y + 10 - gl_y;
+    if (offset < 0) return -1;
+    
+    sim_mutex_lock(&viz_context.mutex);
+    int num_gangs = viz_context.num_gangs;
+    int scroll_offset = gang_rows_offset(viz_context.gang_list_scroll);
+    int row = gang_rows_find(scroll_offset + offset);
+    int hit = -1;
+    if (row < num_gangs) {
+        int row_y = first_row_y - (gang_rows_offset(row) - scroll_offset);
+        if (row_y > LIST_BOTTOM_MARGIN && gl_y >= row_y - 10 && gl_y <= row_y + 10) {
+            hit = row;
+        }
+    }
+    sim_mutex_unlock(&viz_context.mutex);
+    
+    return hit;
+}
+
 // Initialize OpenGL visualization
 void initialize_visualization(int* argc, char** argv, VisualizationContext* ctx) {
     // Set environment variable to force software rendering if needed
@@ -70,8 +224,6 @@ void initialize_visualization(int* argc, char** argv, VisualizationContext* ctx)
     // Register callbacks
     glutDisplayFunc(display_function);
     glutReshapeFunc(reshape_function);
-    glutTimerFunc(ctx->refresh_rate, timer_function, 0);
-    glutIdleFunc(idle_function);
     glutKeyboardFunc(keyboard_function);
     glutSpecialFunc(special_key_function);
     glutMouseFunc(mouse_function);
@@ -81,7 +233,8 @@ void initialize_visualization(int* argc, char** argv, VisualizationContext* ctx)
     // Instead, rely completely on timer-based updates
     
     // Set up timer for simulation updates - uses glutTimerFunc not busy polling
-    glutTimerFunc(ctx->refresh_rate, timer_function, 0);
+    redraw_interval_ms = ctx->refresh_rate;
+    glutTimerFunc(redraw_interval_ms, timer_function, 0);
     
     // Set up clear color to dark slate (#1e1e1e) as per G-4 requirement
     glClearColor(0.12f, 0.12f, 0.12f, 1.0f);
@@ -104,11 +257,11 @@ void initialize_visualization(int* argc, char** argv, VisualizationContext* ctx)
     viz_context.gang_list_scroll = 0;
     viz_context.target_list_scroll = 0;
     
-    // Initialize gang expansion tracking
-    viz_context.expanded_gangs = (bool*)calloc(viz_context.num_gangs, sizeof(bool));
+    // Gang expansion tracking comes with the viewer state
     if (!viz_context.expanded_gangs) {
-        fprintf(stderr, "Error: Failed to allocate memory for expanded_gangs array\n");
+        fprintf(stderr, "Error: No expanded_gangs array, call viewer_state_init first\n");
     }
+    gang_rows_reset(viz_context.num_gangs, false);
     
     printf("OpenGL visualization initialized successfully\n");
     // glutMainLoop() will be called in the visualization thread
@@ -116,14 +269,11 @@ void initialize_visualization(int* argc, char** argv, VisualizationContext* ctx)
 
 // Display callback function
 void display_function() {
-    // Thread-safe access to visualization context
-    bool simulation_running;
-    pthread_mutex_lock(&viz_context.mutex);
-    simulation_running = viz_context.simulation_running;
-    pthread_mutex_unlock(&viz_context.mutex);
+    // Take the newest published snapshot - the whole frame draws from it without locking
+    const VisSnapshot* snapshot = vis_snapshot_acquire();
     
-    // Check if the visualization context is properly initialized
-    if (!simulation_running) {
+    // Check if the updater has published anything yet
+    if (snapshot == NULL) {
         // Something's wrong, just clear the screen to dark slate and return
         glClearColor(0.12f, 0.12f, 0.12f, 1.0f); // #1e1e1e dark slate
         glClear(GL_COLOR_BUFFER_BIT);
@@ -131,6 +281,9 @@ void display_function() {
         return;
     }
 
+    // Start collecting this frame's geometry and text
+    render_batch_begin(viz_context.window_width, viz_context.window_height);
+
     // G-4: Clear background to dark slate color (#1e1e1e)
     glClearColor(0.12f, 0.12f, 0.12f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -148,41 +301,39 @@ void display_function() {
     int window_height = viz_context.window_height;
     
     // Calculate column widths and positions
-    int left_col_width = window_width * 0.25;    // 25% of window width
-    int center_col_width = window_width * 0.5;   // 50% of window width
-    int right_col_width = window_width * 0.25;   // 25% of window width
+    int left_col_width = window_width * LEFT_COLUMN_FRACTION;
+    int center_col_width = window_width * CENTER_COLUMN_FRACTION;
+    int right_col_width = window_width - left_col_width - center_col_width;
+    int panel_height = window_height * PANEL_HEIGHT_FRACTION;
     
     int left_col_x = 0;
     int center_col_x = left_col_width;
     int right_col_x = left_col_width + center_col_width;
     
     // Draw subtle column dividers
-    glColor4f(0.3f, 0.3f, 0.3f, 0.5f);
+    render_set_color(0.3f, 0.3f, 0.3f, 0.5f);
     
     // Left-center divider
-    glBegin(GL_LINES);
-    glVertex2f(left_col_width, 0);
-    glVertex2f(left_col_width, window_height);
-    glEnd();
+    render_line(left_col_width, 0, left_col_width, window_height);
     
     // Center-right divider
-    glBegin(GL_LINES);
-    glVertex2f(right_col_x, 0);
-    glVertex2f(right_col_x, window_height);
-    glEnd();
+    render_line(right_col_x, 0, right_col_x, window_height);
     
     // G-2: Draw contents in each column
     // Left column: List of gangs with colored status icons
-    draw_gang_list(left_col_x, 0, left_col_width, window_height * 0.9);
+    draw_gang_list(snapshot, left_col_x, 0, left_col_width, panel_height);
     
     // Center column: Current target and progress bar
-    draw_current_target(center_col_x, 0, center_col_width, window_height * 0.9);
+    draw_current_target(snapshot, center_col_x, 0, center_col_width, panel_height);
     
     // Right column: Counters for plans thwarted, succeeded, agents executed
-    draw_counters(right_col_x, 0, right_col_width, window_height * 0.9);
+    draw_counters(snapshot, right_col_x, 0, right_col_width, panel_height);
     
     // Draw status bar at the top
-    draw_status_bar(&viz_context);
+    draw_status_bar(&viz_context, snapshot);
+    
+    // Submit the whole frame - one draw call per primitive type
+    render_batch_flush();
     
     // Disable blending
     glDisable(GL_BLEND);
@@ -215,6 +366,23 @@ void reshape_function(int width, int height) {
     printf("Resized window to %d x %d pixels\n", width, height);
 }
 
+// Version of everything the dashboard shows - bumped when a snapshot is published
+// (the updater folds shared state changes into it) or the user interacts
+static unsigned int current_state_version() {
+    return atomic_load_explicit(&viz_context.data_version, memory_order_acquire);
+}
+
+// Request a redraw after viewer-side data changed or the user interacted
+void visualization_mark_dirty() {
+    atomic_fetch_add_explicit(&viz_context.data_version, 1, memory_order_release);
+}
+
+// Redraw now in response to user input
+static void request_redraw() {
+    visualization_mark_dirty();
+    glutPostRedisplay();
+}
+
 // Timer callback function for simulation updates
 void timer_function(int value) {
     // G-6: CPU Discipline - Only run when window exists and simulation is active
@@ -224,92 +392,107 @@ void timer_function(int value) {
     }
     
     // G-3: Dynamic Updates - Check if the simulation is still running
-    pthread_mutex_lock(&viz_context.mutex);
+    sim_mutex_lock(&viz_context.mutex);
     bool simulation_running = viz_context.simulation_running;
-    // We can't reliably detect if window is visible in all GLUT versions
-    // So just assume it's visible if it exists
-    bool window_visible = true;
-    pthread_mutex_unlock(&viz_context.mutex);
-    
-    if (simulation_running) {
-        if (window_visible) {
-            // Only request redisplay when window is visible
-            glutPostRedisplay();
-            
-            // Update health counter to track visualization thread
-            pthread_mutex_lock(&viz_context.mutex);
-            viz_context.viz_thread_health++;
-            pthread_mutex_unlock(&viz_context.mutex);
-        } else {
-            // G-6: If window not visible, sleep longer to reduce CPU usage
-            usleep(100000); // 100ms sleep when minimized
-        }
-        // Force a redraw to update the visualization
-        glutPostRedisplay();
-        
-        // Set up next timer
-        glutTimerFunc(viz_context.refresh_rate, timer_function, 0);
-    } else {
+    viz_context.viz_thread_health++; // Update health counter to track visualization
+    sim_mutex_unlock(&viz_context.mutex);
+    
+    if (!simulation_running) {
         // If simulation is no longer running, we could exit, but let's just stop the timer
         printf("Simulation stopped, visualization will no longer update\n");
+        return;
+    }
+    
+    // G-6: Only redraw when something the dashboard shows has changed
+    unsigned int version = current_state_version();
+    time_t clock_now = time(NULL);
+    
+    if (version != drawn_version) {
+        // Data changed - redraw and go back to polling at the configured rate
+        drawn_version = version;
+        drawn_clock = clock_now;
+        redraw_interval_ms = viz_context.refresh_rate;
+        glutPostRedisplay();
+    } else {
+        // Idle - back off, only keeping the status bar clock current
+        if (clock_now != drawn_clock) {
+            drawn_clock = clock_now;
+            glutPostRedisplay();
+        }
+        redraw_interval_ms *= 2;
+        if (redraw_interval_ms > VIZ_MAX_IDLE_INTERVAL_MS) {
+            redraw_interval_ms = VIZ_MAX_IDLE_INTERVAL_MS;
+        }
+        if (redraw_interval_ms < viz_context.refresh_rate) {
+            redraw_interval_ms = viz_context.refresh_rate;
+        }
     }
+    
+    // Set up next timer
+    glutTimerFunc(redraw_interval_ms, timer_function, 0);
 }
 
-// Idle function to ensure continuous rendering
+// Idle function - intentionally not registered, an idle callback makes glutMainLoop spin
 void idle_function() {
     // We don't need to do anything here since we're using timer-based updates
 }
 
 // M-2: Keyboard callback function for toggling gang details and scrolling
 void keyboard_function(unsigned char key, int x, int y) {
-    pthread_mutex_lock(&viz_context.mutex);
+    sim_mutex_lock(&viz_context.mutex);
     int num_gangs = viz_context.num_gangs;
-    pthread_mutex_unlock(&viz_context.mutex);
+    sim_mutex_unlock(&viz_context.mutex);
     
     switch(key) {
         // Toggle individual gang details with number keys 0-9
         case '0': case '1': case '2': case '3': case '4':
         case '5': case '6': case '7': case '8': case '9': {
             int gang_index = key - '0';
-            pthread_mutex_lock(&viz_context.mutex);
+            sim_mutex_lock(&viz_context.mutex);
             if (gang_index < num_gangs && viz_context.expanded_gangs != NULL) {
-                viz_context.expanded_gangs[gang_index] = !viz_context.expanded_gangs[gang_index];
+                set_gang_expanded(gang_index, !viz_context.expanded_gangs[gang_index]);
             }
-            pthread_mutex_unlock(&viz_context.mutex);
-            glutPostRedisplay();
+            sim_mutex_unlock(&viz_context.mutex);
+            request_redraw();
             break;
         }
         // '+' key to expand all gangs
         case '+':
         case '=':
-            pthread_mutex_lock(&viz_context.mutex);
-            for (int i = 0; i < num_gangs; i++) {
-                if (viz_context.expanded_gangs != NULL) {
-                    viz_context.expanded_gangs[i] = true;
-                }
+            sim_mutex_lock(&viz_context.mutex);
+            if (viz_context.expanded_gangs != NULL) {
+                memset(viz_context.expanded_gangs, true, num_gangs * sizeof(bool));
+                gang_rows_reset(num_gangs, true);
+                atomic_fetch_add(&viz_context.expansion_version, 1);
             }
-            pthread_mutex_unlock(&viz_context.mutex);
-            glutPostRedisplay();
+            sim_mutex_unlock(&viz_context.mutex);
+            request_redraw();
             break;
         // '-' key to collapse all gangs
         case '-':
-            pthread_mutex_lock(&viz_context.mutex);
-            for (int i = 0; i < num_gangs; i++) {
-                if (viz_context.expanded_gangs != NULL) {
-                    viz_context.expanded_gangs[i] = false;
-                }
+            sim_mutex_lock(&viz_context.mutex);
+            if (viz_context.expanded_gangs != NULL) {
+                memset(viz_context.expanded_gangs, false, num_gangs * sizeof(bool));
+                gang_rows_reset(num_gangs, false);
+                atomic_fetch_add(&viz_context.expansion_version, 1);
             }
-            pthread_mutex_unlock(&viz_context.mutex);
-            glutPostRedisplay();
+            sim_mutex_unlock(&viz_context.mutex);
+            request_redraw();
+            break;
+        // 'l' key to switch the sparklines to the next history resolution
+        case 'l':
+        case 'L':
+            visualization_cycle_history_level();
+            request_redraw();
             break;
         // 'h' key to reset to home position (top of lists)
         case 'h':
         case 'H':
-            pthread_mutex_lock(&viz_context.mutex);
+            sim_mutex_lock(&viz_context.mutex);
             viz_context.gang_list_scroll = 0;
             viz_context.target_list_scroll = 0;
-            pthread_mutex_unlock(&viz_context.mutex);
-            glutPostRedisplay();
+            sim_mutex_unlock(&viz_context.mutex);
+            request_redraw();
             break;
         // ESC to exit
         case 27:
@@ -320,60 +503,60 @@ void keyboard_function(unsigned char key, int x, int y) {
 
 // M-3: Special key callback function for scrolling
 void special_key_function(int key, int x, int y) {
-    pthread_mutex_lock(&viz_context.mutex);
+    sim_mutex_lock(&viz_context.mutex);
     int num_gangs = viz_context.num_gangs;
     int gang_list_scroll = viz_context.gang_list_scroll;
     int target_list_scroll = viz_context.target_list_scroll;
-    pthread_mutex_unlock(&viz_context.mutex);
+    sim_mutex_unlock(&viz_context.mutex);
     
     switch(key) {
         case GLUT_KEY_UP: // Up arrow key
             // Scroll gang list up
             if (gang_list_scroll > 0) {
-                pthread_mutex_lock(&viz_context.mutex);
+                sim_mutex_lock(&viz_context.mutex);
                 viz_context.gang_list_scroll--;
-                pthread_mutex_unlock(&viz_context.mutex);
-                glutPostRedisplay();
+                sim_mutex_unlock(&viz_context.mutex);
+                request_redraw();
             }
             break;
             
         case GLUT_KEY_DOWN: // Down arrow key
             // Scroll gang list down
             if (gang_list_scroll < num_gangs - 1) {
-                pthread_mutex_lock(&viz_context.mutex);
+                sim_mutex_lock(&viz_context.mutex);
                 viz_context.gang_list_scroll++;
-                pthread_mutex_unlock(&viz_context.mutex);
-                glutPostRedisplay();
+                sim_mutex_unlock(&viz_context.mutex);
+                request_redraw();
             }
             break;
             
         case GLUT_KEY_PAGE_UP: // Page Up key
             // Scroll target list up
             if (target_list_scroll > 0) {
-                pthread_mutex_lock(&viz_context.mutex);
+                sim_mutex_lock(&viz_context.mutex);
                 viz_context.target_list_scroll--;
-                pthread_mutex_unlock(&viz_context.mutex);
-                glutPostRedisplay();
+                sim_mutex_unlock(&viz_context.mutex);
+                request_redraw();
             }
             break;
             
         case GLUT_KEY_PAGE_DOWN: // Page Down key
             // Scroll target list down
             if (target_list_scroll < num_gangs - 1) {
-                pthread_mutex_lock(&viz_context.mutex);
+                sim_mutex_lock(&viz_context.mutex);
                 viz_context.target_list_scroll++;
-                pthread_mutex_unlock(&viz_context.mutex);
-                glutPostRedisplay();
+                sim_mutex_unlock(&viz_context.mutex);
+                request_redraw();
             }
             break;
             
         case GLUT_KEY_HOME: // Home key
             // Reset both scrolling positions
-            pthread_mutex_lock(&viz_context.mutex);
+            sim_mutex_lock(&viz_context.mutex);
             viz_context.gang_list_scroll = 0;
             viz_context.target_list_scroll = 0;
-            pthread_mutex_unlock(&viz_context.mutex);
-            glutPostRedisplay();
+            sim_mutex_unlock(&viz_context.mutex);
+            request_redraw();
             break;
     }
 }
@@ -383,40 +566,41 @@ void mouse_function(int button, int state, int x, int y) {
     if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
         // Check if click is within gang expansion area
         if (hover_gang_index >= 0) {
-            pthread_mutex_lock(&viz_context.mutex);
+            sim_mutex_lock(&viz_context.mutex);
             if (hover_gang_index < viz_context.num_gangs && viz_context.expanded_gangs != NULL) {
                 // Toggle the expanded state
-                viz_context.expanded_gangs[hover_gang_index] = !viz_context.expanded_gangs[hover_gang_index];
+                set_gang_expanded(hover_gang_index, !viz_context.expanded_gangs[hover_gang_index]);
             }
-            pthread_mutex_unlock(&viz_context.mutex);
-            glutPostRedisplay();
+            sim_mutex_unlock(&viz_context.mutex);
+            request_redraw();
         }
     }
     // F-4: Handle mouse wheel for scrolling
     else if (button == 3 || button == 4) { // Wheel up (3) or down (4)
-        pthread_mutex_lock(&viz_context.mutex);
+        sim_mutex_lock(&viz_context.mutex);
         int num_gangs = viz_context.num_gangs;
         int max_scroll = num_gangs - 1;
         
-        // Window regions: left third is gang list, middle third is target list
+        // Window regions: same columns as the dashboard layout
         int window_width = viz_context.window_width;
-        int x_third = window_width / 3;
+        int left_col_width = window_width * LEFT_COLUMN_FRACTION;
+        int center_col_width = window_width * CENTER_COLUMN_FRACTION;
         
-        if (x < x_third) { // Left panel - Gang list
+        if (x < left_col_width) { // Left panel - Gang list
             if (button == 3 && viz_context.gang_list_scroll > 0) { // Wheel up
                 viz_context.gang_list_scroll--;
             } else if (button == 4 && viz_context.gang_list_scroll < max_scroll) { // Wheel down
                 viz_context.gang_list_scroll++;
             }
-        } else if (x < 2 * x_third) { // Middle panel - Target list
+        } else if (x < left_col_width + center_col_width) { // Middle panel - Target list
             if (button == 3 && viz_context.target_list_scroll > 0) { // Wheel up
                 viz_context.target_list_scroll--;
             } else if (button == 4 && viz_context.target_list_scroll < max_scroll) { // Wheel down
                 viz_context.target_list_scroll++;
             }
         }
-        pthread_mutex_unlock(&viz_context.mutex);
-        glutPostRedisplay();
+        sim_mutex_unlock(&viz_context.mutex);
+        request_redraw();
     }
 }
 
@@ -425,77 +609,24 @@ void passive_motion_function(int x, int y) {
     mouse_x = x;
     mouse_y = y;
     
-    // Reset hover state
+    // Resolve the hovered expand button directly from the row index
     int old_hover_gang = hover_gang_index;
-    hover_gang_index = -1;
-    
-    // Get window dimensions
-    int window_width = viz_context.window_width;
-    int window_height = viz_context.window_height;
-    
-    // Left panel dimensions (for gang list)
-    int panel_x = 0;
-    int panel_y = 0;
-    int panel_width = window_width / 3;
-    int panel_height = window_height;
+    hover_gang_index = gang_button_at(x, y);
     
-    // Only check for hover if in left panel
-    if (x >= panel_x && x <= panel_x + panel_width) {
-        pthread_mutex_lock(&viz_context.mutex);
-        int num_gangs = viz_context.num_gangs;
-        int scroll_pos = viz_context.gang_list_scroll;
-        bool* expanded_gangs = viz_context.expanded_gangs;
-        pthread_mutex_unlock(&viz_context.mutex);
-        
-        // Calculate gang entry positions similar to draw_gang_list
-        int base_gang_height = 40;
-        int expanded_gang_height = 120;
-        int visible_height = panel_height - 50;
-        int gang_y_offset = panel_height - 70;
-        
-        for (int i = scroll_pos; i < num_gangs && (gang_y_offset > panel_y + 20); i++) {
-            bool is_expanded = (expanded_gangs && i < num_gangs && expanded_gangs[i]);
-            
-            // Check if mouse is over the expand/collapse button area
-            int button_x = panel_x + panel_width - 25;
-            int button_width = 20;
-            int button_height = 20;
-            int button_y = gang_y_offset - 10;
-            
-            if (x >= button_x && x <= button_x + button_width &&
-                y >= window_height - button_y - button_height && y <= window_height - button_y) {
-                hover_gang_index = i;
-                break;
-            }
-            
-            // Move to next gang position
-            gang_y_offset -= base_gang_height;
-            if (is_expanded) {
-                gang_y_offset -= expanded_gang_height - base_gang_height;
-            }
-        }
-        
-        // Force redisplay only if hover state changed
-        if (old_hover_gang != hover_gang_index) {
-            glutPostRedisplay();
-        }
+    // Force redisplay only if hover state changed
+    if (old_hover_gang != hover_gang_index) {
+        request_redraw();
     }
 }
 
 // Function to draw a status bar at the top of the screen
-void draw_status_bar(VisualizationContext* ctx) {
+void draw_status_bar(VisualizationContext* ctx, const VisSnapshot* snapshot) {
     // Draw a background for the status bar
-    glColor4f(0.2f, 0.2f, 0.2f, 0.8f);
-    glBegin(GL_QUADS);
-    glVertex2f(0, ctx->window_height - 30);
-    glVertex2f(ctx->window_width, ctx->window_height - 30);
-    glVertex2f(ctx->window_width, ctx->window_height);
-    glVertex2f(0, ctx->window_height);
-    glEnd();
+    render_set_color(0.2f, 0.2f, 0.2f, 0.8f);
+    render_quad(0, ctx->window_height - 30, ctx->window_width, ctx->window_height);
     
     // Draw simulation status
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glRasterPos2f(10, ctx->window_height - 20);
+    render_set_color(1.0f, 1.0f, 1.0f, 1.0f);
     
     char buffer[100];
     
@@ -505,41 +636,31 @@ void draw_status_bar(VisualizationContext* ctx) {
     
     sprintf(buffer, "Simulation Time: %02d:%02d:%02d | Status: %s", 
             timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
-            ctx->simulation_running ? "Running" : "Stopped");
-    
-    for (int i = 0; i < strlen(buffer); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, buffer[i]);
+            snapshot->simulation_running ? "Running" : "Stopped");
+    render_text(FONT_HELVETICA_12, 10, ctx->window_height - 20, buffer);
+    
+    // Show termination condition if reached
+    if (snapshot->total_successful_missions >= ctx->config.max_successful_plans) {
+        render_set_color(1.0f, 0.5f, 0.0f, 1.0f); // Orange for gangs winning
+        sprintf(buffer, "Gangs Win! (%d missions)", snapshot->total_successful_missions);
+    } else if (snapshot->total_thwarted_missions >= ctx->config.max_thwarted_plans) {
+        render_set_color(0.0f, 0.7f, 1.0f, 1.0f); // Blue for police winning
+        sprintf(buffer, "Police Win! (%d thwarts)", snapshot->total_thwarted_missions);
+    } else if (snapshot->total_executed_agents >= ctx->config.max_executed_agents) {
+        render_set_color(1.0f, 0.0f, 0.0f, 1.0f); // Red for agents executed
+        sprintf(buffer, "Agents Lost! (%d executed)", snapshot->total_executed_agents);
+    } else {
+        // Still running
+        buffer[0] = '\0';
     }
     
-    // Show termination condition if available
-    if (ctx->shared_state != NULL) {
-        if (ctx->shared_state->total_successful_missions >= ctx->config.max_successful_plans) {
-            glColor3f(1.0f, 0.5f, 0.0f); // Orange for gangs winning
-            glRasterPos2f(ctx->window_width - 200, ctx->window_height - 20);
-            sprintf(buffer, "Gangs Win! (%d missions)", ctx->shared_state->total_successful_missions);
-        } else if (ctx->shared_state->total_thwarted_missions >= ctx->config.max_thwarted_plans) {
-            glColor3f(0.0f, 0.7f, 1.0f); // Blue for police winning
-            glRasterPos2f(ctx->window_width - 200, ctx->window_height - 20);
-            sprintf(buffer, "Police Win! (%d thwarts)", ctx->shared_state->total_thwarted_missions);
-        } else if (ctx->shared_state->total_executed_agents >= ctx->config.max_executed_agents) {
-            glColor3f(1.0f, 0.0f, 0.0f); // Red for agents executed
-            glRasterPos2f(ctx->window_width - 200, ctx->window_height - 20);
-            sprintf(buffer, "Agents Lost! (%d executed)", ctx->shared_state->total_executed_agents);
-        } else {
-            // Still running
-            buffer[0] = '\0';
-        }
-        
-        for (int i = 0; i < strlen(buffer); i++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, buffer[i]);
-        }
-    }
+    render_text(FONT_HELVETICA_12, ctx->window_width - 200, ctx->window_height - 20, buffer);
 }
 
 // Function to add visual debugging indicators
 void draw_debug_info(VisualizationContext* ctx) {
     // Set text color
-    glColor3f(1.0f, 1.0f, 0.0f); // Yellow text for visibility
+    render_set_color(1.0f, 1.0f, 0.0f, 1.0f); // Yellow text for visibility
     
     // Draw at top-left corner
     float text_x = 10;
@@ -548,97 +669,125 @@ void draw_debug_info(VisualizationContext* ctx) {
     // Display number of gangs and animation time
     char buffer[100];
     sprintf(buffer, "Debug: %d gangs, %.1f anim time", ctx->num_gangs, ctx->animation_time);
-    glRasterPos2f(text_x, text_y);
-    for (int i = 0; i < strlen(buffer); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, buffer[i]);
-    }
+    render_text(FONT_HELVETICA_12, text_x, text_y, buffer);
     
     // Display address of gang states
     sprintf(buffer, "Gang states: %p", (void*)ctx->gang_states);
-    glRasterPos2f(text_x, text_y - 15);
-    for (int i = 0; i < strlen(buffer); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, buffer[i]);
-    }
+    render_text(FONT_HELVETICA_12, text_x, text_y - 15, buffer);
     
     // Draw coordinate system reference
-    glColor3f(1.0f, 0.0f, 0.0f); // Red for X axis
-    glBegin(GL_LINES);
-    glVertex2f(50, 50);
-    glVertex2f(150, 50);
-    glEnd();
-    glColor3f(0.0f, 1.0f, 0.0f); // Green for Y axis
-    glBegin(GL_LINES);
-    glVertex2f(50, 50);
-    glVertex2f(50, 150);
-    glEnd();
+    render_set_color(1.0f, 0.0f, 0.0f, 1.0f); // Red for X axis
+    render_line(50, 50, 150, 50);
+    render_set_color(0.0f, 1.0f, 0.0f, 1.0f); // Green for Y axis
+    render_line(50, 50, 50, 150);
     
     // Draw coordinate labels
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glRasterPos2f(150, 55);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, 'X');
-    glRasterPos2f(55, 150);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, 'Y');
+    render_set_color(1.0f, 1.0f, 1.0f, 1.0f);
+    render_text(FONT_HELVETICA_12, 150, 55, "X");
+    render_text(FONT_HELVETICA_12, 55, 150, "Y");
+}
+
+// Sparkline of one gang's history between (x0, y0) and (x1, y1): arrest periods
+// shaded, the preparation min-max band with its average, agent knowledge, and
+// report ticks along the bottom
+static void draw_sparkline(const HistoryBucket rows[HISTORY_METRICS][HISTORY_BUCKETS],
+                           float x0, float y0, float x1, float y1) {
+    float step = (x1 - x0) / HISTORY_BUCKETS;
+    float scale = (y1 - y0) / 100.0f;
+    
+    render_set_color(0.12f, 0.12f, 0.12f, 1.0f);
+    render_quad(x0, y0, x1, y1);
+    
+    for (int i = 0; i < HISTORY_BUCKETS; i++) {
+        const HistoryBucket* arrested = &rows[HISTORY_ARRESTED][i];
+        const HistoryBucket* prep = &rows[HISTORY_PREPARATION][i];
+        const HistoryBucket* reports = &rows[HISTORY_REPORTS][i];
+        float bx = x0 + i * step;
+        
+        if (arrested->count > 0 && arrested->max > 0) {
+            float share = (float)arrested->sum / arrested->count / 100.0f;
+            render_set_color(0.9f, 0.6f, 0.0f, 0.2f + 0.4f * share);
+            render_quad(bx, y0, bx + step, y1);
+        }
+        if (prep->count > 0) {
+            render_set_color(0.0f, 0.4f, 0.5f, 1.0f);
+            render_line(bx + step / 2, y0 + prep->min * scale, bx + step / 2, y0 + prep->max * scale);
+        }
+        if (reports->count > 0 && reports->sum > 0) {
+            float tick = reports->sum > 5 ? 5 : reports->sum;
+            render_set_color(1.0f, 1.0f, 1.0f, 1.0f);
+            render_line(bx + step / 2, y0, bx + step / 2, y0 + tick);
+        }
+    }
+    
+    // Averages as polylines, broken where a bucket has no samples
+    const float line_colors[2][3] = { { 0.0f, 0.9f, 1.0f }, { 1.0f, 0.3f, 0.3f } };
+    const HistoryMetric line_metrics[2] = { HISTORY_PREPARATION, HISTORY_AGENT_KNOWLEDGE };
+    for (int line = 0; line < 2; line++) {
+        const HistoryBucket* buckets = rows[line_metrics[line]];
+        render_set_color(line_colors[line][0], line_colors[line][1], line_colors[line][2], 1.0f);
+        for (int i = 1; i < HISTORY_BUCKETS; i++) {
+            if (buckets[i - 1].count == 0 || buckets[i].count == 0) continue;
+            float avg_before = (float)buckets[i - 1].sum / buckets[i - 1].count;
+            float avg = (float)buckets[i].sum / buckets[i].count;
+            render_line(x0 + (i - 0.5f) * step, y0 + avg_before * scale,
+                        x0 + (i + 0.5f) * step, y0 + avg * scale);
+        }
+    }
 }
 
 // Function to draw the left column showing gang list with status icons
-void draw_gang_list(int x, int y, int width, int height) {
-    // Get thread-safe access to visualization context
-    pthread_mutex_lock(&viz_context.mutex);
-    int num_gangs = viz_context.num_gangs;
+void draw_gang_list(const VisSnapshot* snapshot, int x, int y, int width, int height) {
+    int first_row_y = height - GANG_LIST_FIRST_ROW;
+    int visible_span = first_row_y - (y + LIST_BOTTOM_MARGIN);
+    
+    // Find the visible rows from the row index (scroll and expansion state
+    // belong to the GLUT thread, gang data comes from the frame's snapshot)
+    int num_gangs = snapshot->num_gangs;
     int scroll_pos = viz_context.gang_list_scroll;
     bool* expanded_gangs = viz_context.expanded_gangs;
-    pthread_mutex_unlock(&viz_context.mutex);
-    
-    // Calculate how many gangs can fit in the visible area
-    int base_gang_height = 40;  // Basic height for a collapsed gang entry
-    int expanded_gang_height = 120; // Height when expanded to show members
-    int visible_height = height - 50; // Height available for gang list (subtract title area)
-    int max_gangs_visible = visible_height / base_gang_height;
+    int end = scroll_pos;
+    if (visible_span > 0) {
+        end = gang_rows_find(gang_rows_offset(scroll_pos) + visible_span - 1) + 1;
+        if (end > num_gangs) end = num_gangs;
+    }
     
     // Draw section title
-    glColor3f(1.0f, 1.0f, 1.0f);  // White text
-    glRasterPos2f(x + 10, height - 30);
-    char* title = "ACTIVE GANGS";
-    for (int i = 0; i < strlen(title); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, title[i]);
-    }
+    render_set_color(1.0f, 1.0f, 1.0f, 1.0f);  // White text
+    render_text(FONT_HELVETICA_18, x + 10, height - 30, "ACTIVE GANGS");
+    
+    // Sparkline span, switched with 'l'
+    char span[16];
+    char history_title[32];
+    history_span_label(snapshot->history_level, span, sizeof(span));
+    snprintf(history_title, sizeof(history_title), "last %s", span);
+    render_set_color(0.6f, 0.6f, 0.6f, 1.0f);
+    render_text(FONT_HELVETICA_12, x + width - 45 - render_text_width(FONT_HELVETICA_12, history_title),
+                height - 30, history_title);
     
     // Draw horizontal separator
-    glColor3f(0.4f, 0.4f, 0.4f);
-    glBegin(GL_LINES);
-    glVertex2f(x + 5, height - 40);
-    glVertex2f(x + width - 5, height - 40);
-    glEnd();
+    render_set_color(0.4f, 0.4f, 0.4f, 1.0f);
+    render_line(x + 5, height - 40, x + width - 5, height - 40);
     
     // M-3: Draw scroll indicators if needed
     if (scroll_pos > 0) {
         // Draw up arrow for scrolling up
-        glColor3f(0.7f, 0.7f, 0.7f); // Light gray
-        glBegin(GL_TRIANGLES);
-        glVertex2f(x + width - 20, height - 50);
-        glVertex2f(x + width - 10, height - 60);
-        glVertex2f(x + width - 30, height - 60);
-        glEnd();
+        render_set_color(0.7f, 0.7f, 0.7f, 1.0f); // Light gray
+        render_triangle(x + width - 20, height - 50, x + width - 10, height - 60, x + width - 30, height - 60);
     }
     
-    if (scroll_pos + max_gangs_visible < num_gangs) {
+    if (end < num_gangs) {
         // Draw down arrow for scrolling down
-        glColor3f(0.7f, 0.7f, 0.7f); // Light gray
-        glBegin(GL_TRIANGLES);
-        glVertex2f(x + width - 20, y + 20);
-        glVertex2f(x + width - 10, y + 30);
-        glVertex2f(x + width - 30, y + 30);
-        glEnd();
+        render_set_color(0.7f, 0.7f, 0.7f, 1.0f); // Light gray
+        render_triangle(x + width - 20, y + 20, x + width - 10, y + 30, x + width - 30, y + 30);
     }
     
-    // Draw each gang with status indicator, starting from scroll position
-    int gang_y_offset = height - 70;
+    // Draw only the visible gangs, starting from scroll position
+    int gang_y_offset = first_row_y;
     
-    for (int i = scroll_pos; i < num_gangs && (gang_y_offset > y + 20); i++) {
-        pthread_mutex_lock(&viz_context.mutex);
-        GangVisState gang_state = viz_context.gang_states[i];
-        SharedState* shared_state = viz_context.shared_state;
-        pthread_mutex_unlock(&viz_context.mutex);
+    for (int i = scroll_pos; i < end; i++) {
+        const GangVisState gang_state = snapshot->gang_states[i];
+        bool is_expanded = (expanded_gangs != NULL && expanded_gangs[i]);
         
         // Draw gang status icon (colored circle)
         float circle_x = x + 20;
@@ -648,38 +797,26 @@ void draw_gang_list(int x, int y, int width, int height) {
         // G-4: Choose color based on gang status
         if (!gang_state.is_active) {
             // Red for dismantled gang
-            glColor3f(0.8f, 0.0f, 0.0f);
+            render_set_color(0.8f, 0.0f, 0.0f, 1.0f);
         } else if (gang_state.is_in_prison) {
             // Yellow/amber for imprisoned gang
-            glColor3f(0.9f, 0.6f, 0.0f);
+            render_set_color(0.9f, 0.6f, 0.0f, 1.0f);
         } else {
             // Green for free/active gang
-            glColor3f(0.0f, 0.7f, 0.0f);
+            render_set_color(0.0f, 0.7f, 0.0f, 1.0f);
         }
         
         // Draw status circle
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(circle_x, circle_y); // Center
-        for (int j = 0; j <= 20; j++) {
-            float angle = 2.0f * 3.14159f * j / 20;
-            float x_pos = circle_x + circle_radius * cos(angle);
-            float y_pos = circle_y + circle_radius * sin(angle);
-            glVertex2f(x_pos, y_pos);
-        }
-        glEnd();
+        render_circle(circle_x, circle_y, circle_radius);
         
         // Draw gang name and status
-        glColor3f(1.0f, 1.0f, 1.0f);  // White text
-        glRasterPos2f(x + 40, gang_y_offset + 5);
+        render_set_color(1.0f, 1.0f, 1.0f, 1.0f);  // White text
         
         char gang_info[50];
         sprintf(gang_info, "Gang %d", gang_state.id);
-        for (int j = 0; j < strlen(gang_info); j++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, gang_info[j]);
-        }
+        render_text(FONT_HELVETICA_12, x + 40, gang_y_offset + 5, gang_info);
         
         // Draw status text
-        glRasterPos2f(x + 40, gang_y_offset - 10);
         char* status_text;
         if (!gang_state.is_active) {
             status_text = "Dismantled";
@@ -688,221 +825,180 @@ void draw_gang_list(int x, int y, int width, int height) {
         } else {
             status_text = "Active";
         }
+        render_text(FONT_HELVETICA_12, x + 40, gang_y_offset - 10, status_text);
         
-        for (int j = 0; j < strlen(status_text); j++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, status_text[j]);
+        // History sparkline between the status text and the expand button
+        float spark_x0 = x + 110;
+        float spark_x1 = x + width - 40;
+        if (snapshot->has_history[i] && spark_x1 - spark_x0 >= 40) {
+            draw_sparkline((const HistoryBucket (*)[HISTORY_BUCKETS])
+                               &snapshot->history[(size_t)i * HISTORY_METRICS * HISTORY_BUCKETS],
+                           spark_x0, gang_y_offset - 12, spark_x1, gang_y_offset + 10);
         }
         
         // F-2: Draw expand/collapse indicator with hover effect
         if (i == hover_gang_index) {
-            glColor3f(1.0f, 1.0f, 0.5f); // Highlight color when hovered
+            render_set_color(1.0f, 1.0f, 0.5f, 1.0f); // Highlight color when hovered
         } else {
-            glColor3f(0.6f, 0.6f, 0.6f); // Normal gray
+            render_set_color(0.6f, 0.6f, 0.6f, 1.0f); // Normal gray
         }
         
         // F-2: Draw proper Unicode-style arrows (simulated with OpenGL)
-        if (expanded_gangs && i < viz_context.num_gangs && expanded_gangs[i]) {
+        if (is_expanded) {
             // Draw ▼ (expanded) using triangles
-            glBegin(GL_TRIANGLES);
-            glVertex2f(x + width - 20, gang_y_offset + 5);
-            glVertex2f(x + width - 10, gang_y_offset - 5);
-            glVertex2f(x + width - 30, gang_y_offset - 5);
-            glEnd();
+            render_triangle(x + width - 20, gang_y_offset + 5,
+                            x + width - 10, gang_y_offset - 5,
+                            x + width - 30, gang_y_offset - 5);
         } else {
             // Draw ► (collapsed) using triangles
-            glBegin(GL_TRIANGLES);
-            glVertex2f(x + width - 25, gang_y_offset + 5);
-            glVertex2f(x + width - 15, gang_y_offset);
-            glVertex2f(x + width - 25, gang_y_offset - 5);
-            glEnd();
+            render_triangle(x + width - 25, gang_y_offset + 5,
+                            x + width - 15, gang_y_offset,
+                            x + width - 25, gang_y_offset - 5);
         }
         
         // F-3: If expanded, show gang member details in a table format
-        if (expanded_gangs && i < viz_context.num_gangs && expanded_gangs[i] && gang_state.is_active) {
-            // F-3: Draw background for expanded section - alternating dark/darker for readability
-            int expanded_height = (gang_state.num_members * 15) + 40; // Header + rows
+        if (is_expanded && gang_state.is_active) {
+            // F-3: Background for the expanded section, filling the expanded row
+            int expanded_height = GANG_EXPANDED_ROW_HEIGHT - GANG_ROW_HEIGHT + 20;
             
             // Background for expanded area
-            glColor3f(0.18f, 0.18f, 0.18f); // Darker background
-            glBegin(GL_QUADS);
-            glVertex2f(x + 5, gang_y_offset - 15);
-            glVertex2f(x + width - 5, gang_y_offset - 15);
-            glVertex2f(x + width - 5, gang_y_offset - 15 - expanded_height);
-            glVertex2f(x + 5, gang_y_offset - 15 - expanded_height);
-            glEnd();
+            render_set_color(0.18f, 0.18f, 0.18f, 1.0f); // Darker background
+            render_quad(x + 5, gang_y_offset - 15 - expanded_height, x + width - 5, gang_y_offset - 15);
             
             // F-3: Draw member table header with monospace font
             int header_y = gang_y_offset - 30;
-            glColor3f(0.9f, 0.9f, 0.9f); // White/light gray for header
+            render_set_color(0.9f, 0.9f, 0.9f, 1.0f); // White/light gray for header
             
             // Column headers with spacing for alignment
-            glRasterPos2f(x + 15, header_y);
-            char* header = "ID   Rank  Prep%  Agent  Status";
-            for (int j = 0; j < strlen(header); j++) {
-                glutBitmapCharacter(GLUT_BITMAP_8_BY_13, header[j]);
-            }
+            render_text(FONT_FIXED_8_BY_13, x + 15, header_y, "ID Rank Prep Know Agent Status");
             
             // Draw separator line under header
-            glColor3f(0.4f, 0.4f, 0.4f);
-            glBegin(GL_LINES);
-            glVertex2f(x + 10, header_y - 5);
-            glVertex2f(x + width - 10, header_y - 5);
-            glEnd();
+            render_set_color(0.4f, 0.4f, 0.4f, 1.0f);
+            render_line(x + 10, header_y - 5, x + width - 10, header_y - 5);
             
-            // F-3: Simulate member data rows with different statuses
-            // In a real implementation, this would pull from shared memory
+            // F-3: Member rows from the gang's shared-memory member table
             int row_start_y = header_y - 20;
             int row_height = 15;
+            int num_members = snapshot->member_counts[i];
+            const GangMemberRecord* members = &snapshot->members[i * MAX_SHARED_MEMBERS];
             
-            // Simulated member data for demonstration (up to 5 members for space)
-            int num_members_to_show = gang_state.num_members > 0 ? 
-                                       (gang_state.num_members < 5 ? gang_state.num_members : 5) : 3;
+            if (num_members <= 0) {
+                render_set_color(0.6f, 0.6f, 0.6f, 1.0f);
+                render_text(FONT_FIXED_8_BY_13, x + 15, row_start_y,
+                            num_members < 0 ? "Waiting for member data..." : "No members");
+            }
             
-            for (int j = 0; j < num_members_to_show; j++) {
+            // Up to MEMBER_ROWS_SHOWN rows fit; the last one summarizes the rest
+            int num_rows = num_members > MEMBER_ROWS_SHOWN ? MEMBER_ROWS_SHOWN - 1 : num_members;
+            for (int j = 0; j < num_rows; j++) {
+                const GangMemberRecord* member = &members[j];
+                int row_y = row_start_y - (j * row_height);
+                
                 // Alternate row background for readability
                 if (j % 2 == 1) {
-                    glColor3f(0.22f, 0.22f, 0.22f); // Slightly lighter for alternating rows
-                    glBegin(GL_QUADS);
-                    glVertex2f(x + 10, row_start_y - (j * row_height) + 12);
-                    glVertex2f(x + width - 10, row_start_y - (j * row_height) + 12);
-                    glVertex2f(x + width - 10, row_start_y - (j * row_height) - 3);
-                    glVertex2f(x + 10, row_start_y - (j * row_height) - 3);
-                    glEnd();
+                    render_set_color(0.22f, 0.22f, 0.22f, 1.0f); // Slightly lighter for alternating rows
+                    render_quad(x + 10, row_y - 3, x + width - 10, row_y + 12);
                 }
                 
-                // Generate sample ID (2 digits)
-                int member_id = 10 + j;
-                
-                // Generate sample rank (1-5)
-                int rank = (i + j) % 5 + 1;
-                
-                // Generate sample prep percentage (0-100%)
-                int prep = (i * 10 + j * 7) % 100;
-                
-                // Determine if member is an agent ( symbol for agents)
-                bool is_agent = (j == 1 || j == 3); // Example: members 1 and 3 are agents
-                
-                // Determine status (Alive, Dead, Prison)
-                int status_type = j % 3; // 0=Alive, 1=Prison, 2=Dead
-                
                 // Draw row data
                 char row_data[50];
-                sprintf(row_data, "%2d   %d     %2d%%   %s    ", 
-                        member_id, rank, prep, is_agent ? "" : "  ");
-                
-                glRasterPos2f(x + 15, row_start_y - (j * row_height));
-                glColor3f(0.9f, 0.9f, 0.9f); // Default text color
+                snprintf(row_data, sizeof(row_data), "%2d %-4d %3d%% %3d%% %-5s ",
+                         member->id, member->rank, member->preparation, member->knowledge,
+                         (member->flags & MEMBER_FLAG_AGENT) ? "yes" : "");
                 
                 // Draw the formatted row data with monospace font
-                for (int k = 0; k < strlen(row_data); k++) {
-                    glutBitmapCharacter(GLUT_BITMAP_8_BY_13, row_data[k]);
-                }
+                render_set_color(0.9f, 0.9f, 0.9f, 1.0f); // Default text color
+                render_text(FONT_FIXED_8_BY_13, x + 15, row_y, row_data);
                 
                 // Draw status with color coding
                 char* status_text;
-                switch(status_type) {
-                    case 0: // Alive - Green
-                        glColor3f(0.0f, 0.8f, 0.0f);
-                        status_text = "Alive";
-                        break;
-                    case 1: // Prison - Blue
-                        glColor3f(0.0f, 0.7f, 1.0f);
-                        status_text = "Prison";
-                        break;
-                    case 2: // Dead - Red
-                        glColor3f(1.0f, 0.0f, 0.0f);
-                        status_text = "Dead";
-                        break;
+                if (!(member->flags & MEMBER_FLAG_ALIVE)) {
+                    render_set_color(1.0f, 0.0f, 0.0f, 1.0f); // Dead - Red
+                    status_text = "Dead";
+                } else if (member->flags & MEMBER_FLAG_IN_PRISON) {
+                    render_set_color(0.0f, 0.7f, 1.0f, 1.0f); // Prison - Blue
+                    status_text = "Prison";
+                } else {
+                    render_set_color(0.0f, 0.8f, 0.0f, 1.0f); // Alive - Green
+                    status_text = "Alive";
                 }
                 
-                // Draw the status text
-                for (int k = 0; k < strlen(status_text); k++) {
-                    glutBitmapCharacter(GLUT_BITMAP_8_BY_13, status_text[k]);
-                }
+                // Draw the status text right after the row data
+                render_text(FONT_FIXED_8_BY_13, x + 15 + render_text_width(FONT_FIXED_8_BY_13, row_data),
+                            row_y, status_text);
             }
             
-            // When expanded, we need more vertical space
-            gang_y_offset -= expanded_gang_height - base_gang_height;
+            if (num_members > num_rows) {
+                char more[32];
+                snprintf(more, sizeof(more), "... %d more", num_members - num_rows);
+                render_set_color(0.6f, 0.6f, 0.6f, 1.0f);
+                render_text(FONT_FIXED_8_BY_13, x + 15, row_start_y - num_rows * row_height, more);
+            }
         }
         
-        // Move to next gang in the list
-        gang_y_offset -= base_gang_height;
+        // Move to next gang in the list - same heights as the row index
+        gang_y_offset -= is_expanded ? GANG_EXPANDED_ROW_HEIGHT : GANG_ROW_HEIGHT;
     }
 
 }
 
 // Function to draw the center panel with current target and progress bar
-void draw_current_target(int x, int y, int width, int height) {
-    // Get thread-safe access to visualization context
-    pthread_mutex_lock(&viz_context.mutex);
-    int num_gangs = viz_context.num_gangs;
-    int scroll_pos = viz_context.target_list_scroll;
-    pthread_mutex_unlock(&viz_context.mutex);
+void draw_current_target(const VisSnapshot* snapshot, int x, int y, int width, int height) {
+    // Rows have a fixed height, so the visible range is plain arithmetic
+    int first_row_y = height - TARGET_LIST_FIRST_ROW;
+    int visible_span = first_row_y - (y + LIST_BOTTOM_MARGIN);
+    int max_gangs_visible = visible_span > 0 ? (visible_span + TARGET_ROW_HEIGHT - 1) / TARGET_ROW_HEIGHT : 0;
     
-    // Calculate how many gangs can fit in the visible area
-    int gang_item_height = 90;
-    int visible_height = height - 50; // Height available for target list (subtract title area)
-    int max_gangs_visible = (int)(visible_height / (float)gang_item_height); // Explicit float conversion
+    int num_gangs = snapshot->num_gangs;
+    int scroll_pos = viz_context.target_list_scroll;
+    int end = scroll_pos + max_gangs_visible;
+    if (end > num_gangs) end = num_gangs;
     
     // Draw section title
-    glColor3f(1.0f, 1.0f, 1.0f);  // White text
-    glRasterPos2f(x + (width / 2.0f) - 80, height - 30);
-    char* title = "CURRENT OPERATIONS";
-    for (int i = 0; i < strlen(title); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, title[i]);
-    }
+    render_set_color(1.0f, 1.0f, 1.0f, 1.0f);  // White text
+    render_text(FONT_HELVETICA_18, x + (width / 2.0f) - 80, height - 30, "CURRENT OPERATIONS");
     
     // Draw horizontal separator
-    glColor3f(0.4f, 0.4f, 0.4f);
-    glBegin(GL_LINES);
-    glVertex2f(x + 5, height - 40);
-    glVertex2f(x + width - 5, height - 40);
-    glEnd();
+    render_set_color(0.4f, 0.4f, 0.4f, 1.0f);
+    render_line(x + 5, height - 40, x + width - 5, height - 40);
     
     // M-3: Draw scroll indicators if needed
     if (scroll_pos > 0) {
         // Draw up arrow for scrolling up
-        glColor3f(0.7f, 0.7f, 0.7f); // Light gray
-        glBegin(GL_TRIANGLES);
-        glVertex2f(x + width - 20, height - 50);
-        glVertex2f(x + width - 10, height - 60);
-        glVertex2f(x + width - 30, height - 60);
-        glEnd();
+        render_set_color(0.7f, 0.7f, 0.7f, 1.0f); // Light gray
+        render_triangle(x + width - 20, height - 50, x + width - 10, height - 60, x + width - 30, height - 60);
     }
     
-    if (scroll_pos + max_gangs_visible < num_gangs) {
+    if (end < num_gangs) {
         // Draw down arrow for scrolling down
-        glColor3f(0.7f, 0.7f, 0.7f); // Light gray
-        glBegin(GL_TRIANGLES);
-        glVertex2f(x + width - 20, y + 20);
-        glVertex2f(x + width - 10, y + 30);
-        glVertex2f(x + width - 30, y + 30);
-        glEnd();
+        render_set_color(0.7f, 0.7f, 0.7f, 1.0f); // Light gray
+        render_triangle(x + width - 20, y + 20, x + width - 10, y + 30, x + width - 30, y + 30);
     }
     
     // Draw gang operations status
-    int gang_y_offset = height - 90;
+    int gang_y_offset = first_row_y;
     
-    for (int i = scroll_pos; i < num_gangs && (gang_y_offset > y + 20); i++) { // Display gangs that fit in the visible area
-        pthread_mutex_lock(&viz_context.mutex);
-        GangVisState gang_state = viz_context.gang_states[i];
-        pthread_mutex_unlock(&viz_context.mutex);
+    for (int i = scroll_pos; i < end; i++) { // Display gangs that fit in the visible area
+        const GangVisState gang_state = snapshot->gang_states[i];
+        char gang_label[32];
         
-        if (!gang_state.is_active) continue; // Skip inactive gangs
+        if (!gang_state.is_active) {
+            // Dismantled gangs keep their slot so every row stays at a fixed position
+            render_set_color(0.5f, 0.5f, 0.5f, 1.0f);
+            sprintf(gang_label, "GANG %d DISMANTLED", gang_state.id);
+            render_text(FONT_HELVETICA_12, x + 20, gang_y_offset + 30, gang_label);
+            gang_y_offset -= TARGET_ROW_HEIGHT;
+            continue;
+        }
         
         // Draw gang identifier
-        glColor3f(1.0f, 1.0f, 1.0f);
-        glRasterPos2f(x + 20, gang_y_offset + 30);
+        render_set_color(1.0f, 1.0f, 1.0f, 1.0f);
         
-        char gang_label[20];
         sprintf(gang_label, "GANG %d TARGET:", gang_state.id);
-        for (int j = 0; j < strlen(gang_label); j++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, gang_label[j]);
-        }
+        render_text(FONT_HELVETICA_12, x + 20, gang_y_offset + 30, gang_label);
         
         // Draw target name
-        glColor3f(0.9f, 0.7f, 0.2f);  // Amber/gold color for target
-        glRasterPos2f(x + 130, gang_y_offset + 30);
+        render_set_color(0.9f, 0.7f, 0.2f, 1.0f);  // Amber/gold color for target
         
         // Convert crime type to text
         char* crime_name;
@@ -916,10 +1012,7 @@ void draw_current_target(int x, int y, int width, int height) {
             case ARM_TRAFFICKING: crime_name = "ARMS DEALING"; break;
             default: crime_name = "UNKNOWN OPERATION"; break;
         }
-        
-        for (int j = 0; j < strlen(crime_name); j++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, crime_name[j]);
-        }
+        render_text(FONT_HELVETICA_12, x + 130, gang_y_offset + 30, crime_name);
         
         // G-4: Draw progress bar
         int bar_width = width - 40;
@@ -928,13 +1021,8 @@ void draw_current_target(int x, int y, int width, int height) {
         int bar_y = gang_y_offset;
         
         // Draw background (gray)
-        glColor3f(0.3f, 0.3f, 0.3f);
-        glBegin(GL_QUADS);
-        glVertex2f(bar_x, bar_y);
-        glVertex2f(bar_x + bar_width, bar_y);
-        glVertex2f(bar_x + bar_width, bar_y + bar_height);
-        glVertex2f(bar_x, bar_y + bar_height);
-        glEnd();
+        render_set_color(0.3f, 0.3f, 0.3f, 1.0f);
+        render_quad(bar_x, bar_y, bar_x + bar_width, bar_y + bar_height);
         
         // Calculate filled portion
         float fill_percentage = gang_state.preparation_level / 100.0f;
@@ -944,136 +1032,346 @@ void draw_current_target(int x, int y, int width, int height) {
         // G-4: Choose progress bar color based on completion percentage
         if (fill_percentage < 0.5f) {
             // < 50% → dim gray
-            glColor3f(0.4f, 0.4f, 0.4f);
+            render_set_color(0.4f, 0.4f, 0.4f, 1.0f);
         } else if (fill_percentage < 0.8f) {
             // 50–80% → amber
-            glColor3f(0.9f, 0.6f, 0.0f);
+            render_set_color(0.9f, 0.6f, 0.0f, 1.0f);
         } else {
             // ≥ 80% → crimson
-            glColor3f(0.8f, 0.0f, 0.2f);
+            render_set_color(0.8f, 0.0f, 0.2f, 1.0f);
         }
         
         // Draw filled portion
-        glBegin(GL_QUADS);
-        glVertex2f(bar_x, bar_y);
-        glVertex2f(bar_x + fill_width, bar_y);
-        glVertex2f(bar_x + fill_width, bar_y + bar_height);
-        glVertex2f(bar_x, bar_y + bar_height);
-        glEnd();
+        render_quad(bar_x, bar_y, bar_x + fill_width, bar_y + bar_height);
         
         // Draw percentage text
-        glColor3f(1.0f, 1.0f, 1.0f);
+        render_set_color(1.0f, 1.0f, 1.0f, 1.0f);
         char percentage_text[10];
         sprintf(percentage_text, "%d%%", gang_state.preparation_level);
         
         // Center percentage text on the bar
-        int text_width = glutBitmapLength(GLUT_BITMAP_HELVETICA_12, (const unsigned char*)percentage_text);
-        glRasterPos2f(bar_x + (bar_width - text_width) / 2.0f, bar_y + 5); // Use explicit float division
-        
-        for (int j = 0; j < strlen(percentage_text); j++) {
-            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, percentage_text[j]);
-        }
+        int text_width = render_text_width(FONT_HELVETICA_12, percentage_text);
+        render_text(FONT_HELVETICA_12, bar_x + (bar_width - text_width) / 2.0f, bar_y + 5, percentage_text);
         
         // Move to next gang
-        gang_y_offset -= gang_item_height;
+        gang_y_offset -= TARGET_ROW_HEIGHT;
     }
 }
 
 // Function to draw the right column with counters
-void draw_counters(int x, int y, int width, int height) {
-    // Get thread-safe access to visualization context
-    pthread_mutex_lock(&viz_context.mutex);
-    SharedState* shared_state = viz_context.shared_state;
-    SimulationConfig config = viz_context.config;
-    pthread_mutex_unlock(&viz_context.mutex);
-    
-    // Only proceed if we have valid shared state
-    if (!shared_state) return;
+void draw_counters(const VisSnapshot* snapshot, int x, int y, int width, int height) {
+    // Configuration never changes after startup
+    const SimulationConfig* config = &viz_context.config;
     
     // Draw section title
-    glColor3f(1.0f, 1.0f, 1.0f);  // White text
-    glRasterPos2f(x + 20, height - 30);
-    char* title = "STATISTICS";
-    for (int i = 0; i < strlen(title); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, title[i]);
-    }
+    render_set_color(1.0f, 1.0f, 1.0f, 1.0f);  // White text
+    render_text(FONT_HELVETICA_18, x + 20, height - 30, "STATISTICS");
     
     // Draw horizontal separator
-    glColor3f(0.4f, 0.4f, 0.4f);
-    glBegin(GL_LINES);
-    glVertex2f(x + 5, height - 40);
-    glVertex2f(x + width - 5, height - 40);
-    glEnd();
+    render_set_color(0.4f, 0.4f, 0.4f, 1.0f);
+    render_line(x + 5, height - 40, x + width - 5, height - 40);
     
     // Define counter positions
     int counter_y = height - 80;
     int counter_spacing = 100;
     
     // G-2: Draw Plans Thwarted counter
-    glColor3f(0.0f, 0.7f, 1.0f);  // Blue for police/thwarted
-    glRasterPos2f(x + 20, counter_y);
-    char thwarted_label[] = "PLANS THWARTED:";
-    for (int i = 0; i < strlen(thwarted_label); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, thwarted_label[i]);
-    }
+    render_set_color(0.0f, 0.7f, 1.0f, 1.0f);  // Blue for police/thwarted
+    render_text(FONT_HELVETICA_12, x + 20, counter_y, "PLANS THWARTED:");
     
     // Draw counter value with max
     char thwarted_value[30];
     sprintf(thwarted_value, "%d / %d", 
-            shared_state->total_thwarted_missions,
-            config.max_thwarted_plans);
-    
-    glRasterPos2f(x + 20, counter_y - 20);
-    for (int i = 0; i < strlen(thwarted_value); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, thwarted_value[i]);
-    }
+            snapshot->total_thwarted_missions,
+            config->max_thwarted_plans);
+    render_text(FONT_HELVETICA_18, x + 20, counter_y - 20, thwarted_value);
     
     // G-2: Draw Plans Succeeded counter
     counter_y -= counter_spacing;
-    glColor3f(0.9f, 0.5f, 0.0f);  // Orange for gang success
-    glRasterPos2f(x + 20, counter_y);
-    char succeeded_label[] = "PLANS SUCCEEDED:";
-    for (int i = 0; i < strlen(succeeded_label); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, succeeded_label[i]);
-    }
+    render_set_color(0.9f, 0.5f, 0.0f, 1.0f);  // Orange for gang success
+    render_text(FONT_HELVETICA_12, x + 20, counter_y, "PLANS SUCCEEDED:");
     
     // Draw counter value with max
     char succeeded_value[30];
     sprintf(succeeded_value, "%d / %d", 
-            shared_state->total_successful_missions,
-            config.max_successful_plans);
-    
-    glRasterPos2f(x + 20, counter_y - 20);
-    for (int i = 0; i < strlen(succeeded_value); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, succeeded_value[i]);
-    }
+            snapshot->total_successful_missions,
+            config->max_successful_plans);
+    render_text(FONT_HELVETICA_18, x + 20, counter_y - 20, succeeded_value);
     
     // G-2: Draw Agents Executed counter
     counter_y -= counter_spacing;
-    glColor3f(0.8f, 0.0f, 0.0f);  // Red for executed agents
-    glRasterPos2f(x + 20, counter_y);
-    char executed_label[] = "AGENTS EXECUTED:";
-    for (int i = 0; i < strlen(executed_label); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, executed_label[i]);
-    }
+    render_set_color(0.8f, 0.0f, 0.0f, 1.0f);  // Red for executed agents
+    render_text(FONT_HELVETICA_12, x + 20, counter_y, "AGENTS EXECUTED:");
     
     // Draw counter value with max
     char executed_value[30];
     sprintf(executed_value, "%d / %d", 
-            shared_state->total_executed_agents,
-            config.max_executed_agents);
+            snapshot->total_executed_agents,
+            config->max_executed_agents);
+    render_text(FONT_HELVETICA_18, x + 20, counter_y - 20, executed_value);
+}
+
+// Member table generations, expansion state and history bucket the last
+// snapshot was built from (updating thread only)
+static unsigned int copied_member_generation[MAX_SHARED_GANGS];
+static unsigned int copied_expansion_version;
+static int copied_history_level = -1;
+static long long copied_history_bucket = -1;
+
+// Newest history bucket number of `level` at the current time
+static long long current_history_bucket(int level) {
+    return monotonic_time_us() / 1000000 / history_level_seconds(level);
+}
+
+// Switch the sparklines to the next history resolution
+void visualization_cycle_history_level() {
+    int level = atomic_load(&viz_context.history_level);
+    atomic_store(&viz_context.history_level, (level + 1) % HISTORY_LEVELS);
+}
+
+// Whether an expanded gang's member table, the set of expanded gangs, or the
+// sparklines (a history bucket closed, or another resolution was picked) changed
+// since the last snapshot. Only the updating thread may call this.
+bool visualization_details_changed() {
+    SharedState* shared_state = viz_context.shared_state;
+    if (shared_state == NULL) return false;
+    
+    int level = atomic_load(&viz_context.history_level);
+    if (level != copied_history_level || current_history_bucket(level) != copied_history_bucket) return true;
+    
+    bool* expanded_gangs = viz_context.expanded_gangs;
+    if (expanded_gangs == NULL) return false;
+    if (atomic_load(&viz_context.expansion_version) != copied_expansion_version) return true;
+    
+    for (int i = 0; i < viz_context.num_gangs && i < MAX_SHARED_GANGS; i++) {
+        if (expanded_gangs[i] && member_table_generation(shared_state, i) != copied_member_generation[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Capture the updater's gang states and the shared counters into one snapshot
+// and hand it to the renderer. Only the updating thread may call this.
+void visualization_publish_snapshot() {
+    VisSnapshot* snapshot = vis_snapshot_back_buffer();
+    SharedState* shared_state = viz_context.shared_state;
+    if (snapshot == NULL || viz_context.gang_states == NULL || shared_state == NULL) return;
+    
+    memcpy(snapshot->gang_states, viz_context.gang_states, snapshot->num_gangs * sizeof(GangVisState));
+    
+    // Member tables are only copied for the gangs whose rows show them
+    bool* expanded_gangs = viz_context.expanded_gangs;
+    copied_expansion_version = atomic_load(&viz_context.expansion_version);
+    for (int i = 0; i < snapshot->num_gangs; i++) {
+        snapshot->member_counts[i] = -1;
+        if (expanded_gangs == NULL || !expanded_gangs[i] || i >= MAX_SHARED_GANGS) continue;
+        
+        int count = 0;
+        unsigned int generation = read_member_table(shared_state, i,
+                                                    &snapshot->members[i * MAX_SHARED_MEMBERS], &count);
+        if (generation != 0) {
+            snapshot->member_counts[i] = count;
+            copied_member_generation[i] = generation;
+        }
+    }
+    
+    // Sparklines: one resolution level of every gang's history, oldest bucket first
+    int level = atomic_load(&viz_context.history_level);
+    long long now_s = monotonic_time_us() / 1000000;
+    snapshot->history_level = level;
+    copied_history_level = level;
+    copied_history_bucket = now_s / history_level_seconds(level);
+    for (int i = 0; i < snapshot->num_gangs; i++) {
+        HistoryBucket (*rows)[HISTORY_BUCKETS] =
+            (HistoryBucket (*)[HISTORY_BUCKETS])&snapshot->history[(size_t)i * HISTORY_METRICS * HISTORY_BUCKETS];
+        snapshot->has_history[i] = i < MAX_SHARED_GANGS &&
+                                   history_read(&shared_state->gang_history[i], level, now_s, rows);
+    }
+    snapshot->total_successful_missions = shared_state->total_successful_missions;
+    snapshot->total_thwarted_missions = shared_state->total_thwarted_missions;
+    snapshot->total_executed_agents = shared_state->total_executed_agents;
+    snapshot->simulation_running = shared_state->simulation_running;
+    
+    sim_mutex_lock(&viz_context.mutex);
+    snapshot->animation_time = viz_context.animation_time;
+    sim_mutex_unlock(&viz_context.mutex);
+    
+    vis_snapshot_publish();
+    visualization_mark_dirty();
+}
+
+// Thread function for visualization loop
+void* visualization_thread_func(void* arg) {
+    printf("Starting visualization thread...\n");
+    
+    // Mark thread as running and initialize health counter
+    sim_mutex_lock(&viz_context.mutex);
+    viz_context.viz_thread_running = true;
+    viz_context.viz_thread_health = 1;
+    sim_mutex_unlock(&viz_context.mutex);
+    
+    // Check if DISPLAY environment is available
+    char* display = getenv("DISPLAY");
+    if (!display || strlen(display) == 0) {
+        fprintf(stderr, "Warning: No DISPLAY environment variable set. Falling back to text-only mode.\n");
+        
+        // On a terminal: diff-based dashboard, redrawn on new snapshots, key presses or the clock
+        if (term_dashboard_active()) {
+            unsigned int drawn_sequence = 0;
+            time_t drawn_clock = 0;
+            bool view_changed = true;
+            while (1) {
+                bool keep_running;
+                sim_mutex_lock(&viz_context.mutex);
+                keep_running = viz_context.simulation_running;
+                viz_context.viz_thread_health++; // Increment health counter
+                sim_mutex_unlock(&viz_context.mutex);
+                
+                if (!keep_running) break;
+                
+                const VisSnapshot* snapshot = vis_snapshot_acquire();
+                time_t now = time(NULL);
+                if (snapshot != NULL && (view_changed || snapshot->sequence != drawn_sequence || now != drawn_clock)) {
+                    term_dashboard_draw(snapshot, &viz_context.config);
+                    drawn_sequence = snapshot->sequence;
+                    drawn_clock = now;
+                }
+                
+                view_changed = term_dashboard_wait_input(viz_context.refresh_rate);
+            }
+            
+            // Mark thread as stopped before exiting
+            sim_mutex_lock(&viz_context.mutex);
+            viz_context.viz_thread_running = false;
+            sim_mutex_unlock(&viz_context.mutex);
+            return NULL;
+        }
+        
+        // Output is not a terminal - print plain text frames
+        int frame = 0;
+        while (1) {
+            // Thread-safe access to simulation status
+            bool keep_running;
+            sim_mutex_lock(&viz_context.mutex);
+            keep_running = viz_context.simulation_running;
+            viz_context.viz_thread_health++; // Increment health counter
+            sim_mutex_unlock(&viz_context.mutex);
+            
+            if (!keep_running) break;
+            
+            // Each frame prints one consistent snapshot, without locking
+            const VisSnapshot* snapshot = vis_snapshot_acquire();
+            if (snapshot != NULL && frame++ % 5 == 0) {  // Update every 5 frames
+                // Clear screen and print header (ANSI escape sequences)
+                printf("\033[2J\033[H");  // Clear screen and move cursor to top
+                printf("===== Crime Simulation Text Visualization - Frame %d =====\n\n", frame);
+                
+                // Display gang information
+                printf("Gangs:\n");
+                for (int i = 0; i < snapshot->num_gangs; i++) {
+                    printf("  Gang %d: %s\n", i, 
+                        snapshot->gang_states[i].is_in_prison ? "In Prison" : "Active");
+                    printf("    Members: %d, Agents: %d\n", 
+                        snapshot->gang_states[i].num_members,
+                        snapshot->gang_states[i].num_agents);
+                    printf("    Preparation: %d%%\n", 
+                        snapshot->gang_states[i].preparation_level);
+                    printf("    Target: %s\n\n", 
+                        crime_type_to_string(snapshot->gang_states[i].current_target));
+                }
+                
+                // Display simulation statistics
+                printf("\nStatistics:\n");
+                printf("  Successful missions: %d / %d\n", 
+                    snapshot->total_successful_missions,
+                    viz_context.config.max_successful_plans);
+                printf("  Thwarted missions: %d / %d\n", 
+                    snapshot->total_thwarted_missions,
+                    viz_context.config.max_thwarted_plans);
+                printf("  Executed agents: %d / %d\n", 
+                    snapshot->total_executed_agents,
+                    viz_context.config.max_executed_agents);
+                printf("  Animation time: %.1f\n", 
+                    snapshot->animation_time);
+            }
+            usleep(viz_context.refresh_rate * 1000); // Convert ms to μs
+        }
+        
+        // Mark thread as stopped before exiting
+        sim_mutex_lock(&viz_context.mutex);
+        viz_context.viz_thread_running = false;
+        sim_mutex_unlock(&viz_context.mutex);
+        return NULL;
+    }
+    
+    // In graphical mode, this thread should only update data periodically,
+    // NOT try to run the GLUT main loop (which should run in the main thread)
+    printf("Visualization thread started in graphical mode, will update data only\n");
     
-    glRasterPos2f(x + 20, counter_y - 20);
-    for (int i = 0; i < strlen(executed_value); i++) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, executed_value[i]);
+    while (1) {
+        // Thread-safe access to simulation status
+        bool keep_running;
+        sim_mutex_lock(&viz_context.mutex);
+        keep_running = viz_context.simulation_running;
+        viz_context.viz_thread_health++; // Increment health counter
+        
+        // Update animation time
+        viz_context.animation_time += 0.1f;
+        sim_mutex_unlock(&viz_context.mutex);
+        
+        if (!keep_running) break;
+        
+        // Redraws are posted by the GLUT timer when the state version changes
+        usleep(viz_context.refresh_rate * 1000); // Convert ms to μs
     }
+    
+    // Mark thread as stopped before exiting
+    sim_mutex_lock(&viz_context.mutex);
+    viz_context.viz_thread_running = false;
+    sim_mutex_unlock(&viz_context.mutex);
+    return NULL;
+}
+
+// Per-gang viewer state, carved out of one arena for the viewer's lifetime
+static Arena viewer_arena;
+
+// Allocate gang_states and expanded_gangs, zeroed, for num_gangs gangs
+bool viewer_state_init(int num_gangs) {
+    size_t states_size = (size_t)num_gangs * sizeof(GangVisState);
+    size_t expanded_size = (size_t)num_gangs * sizeof(bool);
+    if (!arena_init(&viewer_arena, states_size + expanded_size + 32)) {
+        return false;
+    }
+    
+    viz_context.gang_states = (GangVisState*)arena_alloc(&viewer_arena, states_size);
+    viz_context.expanded_gangs = (bool*)arena_alloc(&viewer_arena, expanded_size);
+    if (viz_context.gang_states == NULL || viz_context.expanded_gangs == NULL) {
+        viewer_state_cleanup();
+        return false;
+    }
+    memset(viz_context.gang_states, 0, states_size);
+    memset(viz_context.expanded_gangs, 0, expanded_size);
+    return true;
+}
+
+// Free the viewer state
+void viewer_state_cleanup() {
+    arena_destroy(&viewer_arena);
+    viz_context.gang_states = NULL;
+    viz_context.expanded_gangs = NULL;
 }
 
 // Cleanup visualization resources
 void cleanup_visualization() {
-    // Free allocated memory for expanded gangs tracking
-    if (viz_context.expanded_gangs) {
-        free(viz_context.expanded_gangs);
-        viz_context.expanded_gangs = NULL;
-    }
+    // Release vertex buffers and the glyph atlas
+    render_batch_cleanup();
+    
+    // Free the gang row index
+    free(gang_rows.tree);
+    free(gang_rows.height);
+    gang_rows.tree = NULL;
+    gang_rows.height = NULL;
+    gang_rows.size = 0;
+    gang_rows.num_expanded = 0;
 }